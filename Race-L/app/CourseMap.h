@@ -0,0 +1,33 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * コースマップ（走行距離ごとの曲率）
+ * 偵察走行中にオドメトリの向きの変化から一定距離ごとの曲率を記録し、
+ * 再走行時には先読みした曲率からその地点の上限速度を求める（カーブ手前で減速、抜けたら加速）。
+ * 曲率は1区間あたりint16_tで保持する。
+ */
+class CourseMap {
+public:
+  static const int MAX_BINS = 400;            // 最大区間数（BIN_CM×MAX_BINSまで記録）
+  static const float BIN_CM;                  // 1区間の長さ (cm)
+  static const float CURVATURE_SCALE;         // 保存値 = 曲率[1/cm] × CURVATURE_SCALE
+
+  CourseMap();
+  void clear();                                         // 記録を消去
+  void load(const int16_t *data, int count);            // 保存済みデータを読み込む
+  void record(float distanceCm, float headingDeg);      // 走行中に周期的に呼び、区間ごとの曲率を記録
+  int getBinCount() const;                              // 記録済み区間数
+  int16_t getBin(int index) const;                      // 区間の保存値取得
+  float curvatureAt(float distanceCm) const;            // 指定距離の曲率 (1/cm、正=左カーブ)
+  float speedLimitAt(float distanceCm, float maxSpeedCms, float latAccelCms2, float decelCms2, float lookaheadCm) const; // 上限速度 (cm/s)
+  void dump() const;                                    // CourseMapData.h形式で出力
+
+private:
+  int16_t mBins[MAX_BINS];   // 区間ごとの曲率（量子化済み）
+  int mCount;                // 記録済み区間数
+  float mBinStartHeading;    // 記録中区間の開始時の向き (deg)
+  float mLastDistanceCm;     // 前回取り込んだ走行距離 (cm)
+  float mLastHeadingDeg;     // 前回取り込んだ向き (deg)
+};
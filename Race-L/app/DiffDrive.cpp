@@ -0,0 +1,84 @@
+#include "DiffDrive.h"
+
+// 車体寸法（実機に合わせて調整）
+const float DiffDrive::WHEEL_DIAMETER_CM = 5.4f; // ホイール直径
+const float DiffDrive::TRACK_WIDTH_CM = 11.2f;   // トレッド幅
+
+static const float PI = 3.14159265f;
+
+/**
+ * 走行距離を車輪回転角に換算する
+ * @param cm 走行距離 (cm)
+ * @return 車輪回転角 (deg)
+ */
+float DiffDrive::cmToDeg(float cm)
+{
+  return cm / (PI * WHEEL_DIAMETER_CM) * 360.0f;
+}
+
+/**
+ * 車輪回転角を走行距離に換算する
+ * @param deg 車輪回転角 (deg)
+ * @return 走行距離 (cm)
+ */
+float DiffDrive::degToCm(float deg)
+{
+  return deg / 360.0f * (PI * WHEEL_DIAMETER_CM);
+}
+
+/**
+ * 円弧走行に必要な左右車輪の回転角を求める
+ * 半径がトレッド幅の半分より小さい場合、内側車輪は逆転する。
+ * @param radiusCm 旋回半径 (cm、車体中心基準、0以上)
+ * @param angleDeg 旋回角度 (deg、正=左旋回、負=右旋回)
+ * @param leftDeg [out] 左車輪回転角 (deg)
+ * @param rightDeg [out] 右車輪回転角 (deg)
+ */
+void DiffDrive::arcToWheelDeg(float radiusCm, float angleDeg, float &leftDeg, float &rightDeg)
+{
+  float angleRad = angleDeg * PI / 180.0f;
+  float halfTrack = TRACK_WIDTH_CM / 2.0f;
+  float leftCm;
+  float rightCm;
+
+  if (angleRad >= 0.0f)
+  {
+    // 左旋回：左車輪が内側
+    leftCm = angleRad * (radiusCm - halfTrack);
+    rightCm = angleRad * (radiusCm + halfTrack);
+  }
+  else
+  {
+    // 右旋回：右車輪が内側
+    leftCm = -angleRad * (radiusCm + halfTrack);
+    rightCm = -angleRad * (radiusCm - halfTrack);
+  }
+
+  leftDeg = cmToDeg(leftCm);
+  rightDeg = cmToDeg(rightCm);
+}
+
+/**
+ * 超信地旋回（その場旋回）に必要な左右車輪の回転角を求める
+ * @param angleDeg 旋回角度 (deg、正=左旋回、負=右旋回)
+ * @param leftDeg [out] 左車輪回転角 (deg)
+ * @param rightDeg [out] 右車輪回転角 (deg)
+ */
+void DiffDrive::spinToWheelDeg(float angleDeg, float &leftDeg, float &rightDeg)
+{
+  float arcCm = angleDeg * PI / 180.0f * (TRACK_WIDTH_CM / 2.0f);
+  leftDeg = -cmToDeg(arcCm);
+  rightDeg = cmToDeg(arcCm);
+}
+
+/**
+ * 左右車輪の回転角から車体の向きの変化を求める
+ * @param leftDeg 左車輪回転角 (deg)
+ * @param rightDeg 右車輪回転角 (deg)
+ * @return 向きの変化 (deg、正=左旋回)
+ */
+float DiffDrive::headingDeg(float leftDeg, float rightDeg)
+{
+  float diffCm = degToCm(rightDeg - leftDeg);
+  return diffCm / TRACK_WIDTH_CM * 180.0f / PI;
+}
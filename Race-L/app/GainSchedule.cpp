@@ -0,0 +1,71 @@
+#include "GainSchedule.h"
+#include "GainScheduleTable.h"
+
+/**
+ * 表の並びをコンパイル時に確認する（区間は開始距離の昇順、速度は昇順）
+ */
+static constexpr bool isScheduleOrdered()
+{
+  for (int i = 0; i < GAIN_SCHEDULE_SEGMENT_COUNT; i++)
+  {
+    if (i > 0 && GAIN_SCHEDULE[i].startCm <= GAIN_SCHEDULE[i - 1].startCm)
+    {
+      return false;
+    }
+    for (int j = 1; j < GAIN_SCHEDULE_SPEED_POINTS; j++)
+    {
+      if (GAIN_SCHEDULE[i].points[j].speed <= GAIN_SCHEDULE[i].points[j - 1].speed)
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+static_assert(GAIN_SCHEDULE_SEGMENT_COUNT > 0 && GAIN_SCHEDULE[0].startCm <= 0.0f, "GAIN_SCHEDULEは距離0から始めること");
+static_assert(isScheduleOrdered(), "GAIN_SCHEDULEの区間・速度は昇順に並べること");
+
+/**
+ * 走行距離に対する区間番号を求める
+ * @param distanceCm 走行距離 (cm)
+ * @return 区間番号（開始距離がdistanceCm以下で最後の区間）
+ */
+int GainSchedule::segmentAt(float distanceCm)
+{
+  int segment = 0;
+  while (segment + 1 < GAIN_SCHEDULE_SEGMENT_COUNT && GAIN_SCHEDULE[segment + 1].startCm <= distanceCm)
+  {
+    segment++;
+  }
+  return segment;
+}
+
+/**
+ * 区間を選び、基本速度で線形補間したゲインを求める
+ * @param distanceCm 走行距離 (cm)
+ * @param speed 基本速度（パワー%換算）
+ * @return ゲイン
+ */
+TraceGains GainSchedule::lookup(float distanceCm, int speed)
+{
+  const GainSchedulePoint *points = GAIN_SCHEDULE[segmentAt(distanceCm)].points;
+  if (speed <= points[0].speed)
+  {
+    return points[0].gains;
+  }
+  for (int i = 1; i < GAIN_SCHEDULE_SPEED_POINTS; i++)
+  {
+    if (speed <= points[i].speed)
+    {
+      const TraceGains &low = points[i - 1].gains;
+      const TraceGains &high = points[i].gains;
+      float ratio = (float)(speed - points[i - 1].speed) / (points[i].speed - points[i - 1].speed);
+      TraceGains gains;
+      gains.kp = low.kp + (high.kp - low.kp) * ratio;
+      gains.kd = low.kd + (high.kd - low.kd) * ratio;
+      gains.bias = low.bias + (high.bias - low.bias) * ratio;
+      return gains;
+    }
+  }
+  return points[GAIN_SCHEDULE_SPEED_POINTS - 1].gains;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+/**
+ * ライントレースのゲインスケジュール
+ * コースの区間（走行距離で区切る）ごとに、基本速度に対するKp・Kd・バイアスの表を持ち、
+ * 区間を選んで速度で線形補間する。表はコースごとのGainScheduleTable.hにconstexprで置く。
+ */
+struct TraceGains {
+  float kp;    // 比例定数
+  float kd;    // 微分定数
+  float bias;  // バイアス（旋回量 %）
+};
+
+struct GainSchedulePoint {
+  int speed;         // 基本速度（パワー%換算）
+  TraceGains gains;  // その速度でのゲイン
+};
+
+static constexpr int GAIN_SCHEDULE_SPEED_POINTS = 3;   // 1区間あたりの速度の点数
+
+struct GainScheduleSegment {
+  float startCm;                                           // 区間の開始距離 (cm)
+  GainSchedulePoint points[GAIN_SCHEDULE_SPEED_POINTS];    // 速度の昇順
+};
+
+class GainSchedule {
+public:
+  static int segmentAt(float distanceCm);                 // 走行距離に対する区間番号
+  static TraceGains lookup(float distanceCm, int speed);  // 区間を選び速度で補間したゲイン
+};
@@ -0,0 +1,65 @@
+#include "ImuSampler.h"
+
+// バイアス推定用定数定義
+const float ImuSampler::BIAS_TRACK_RATE = 0.01f;     // 推定完了後は指数平均でゆっくり追従
+const float ImuSampler::STILL_THRESHOLD_DPS = 5.0f;  // これを超える値は動いているとみなして捨てる
+
+ImuSampler::ImuSampler(YawRateReader reader) : mReader(reader),
+                                               mBias(0.0f),
+                                               mBiasCount(0)
+{
+}
+
+/**
+ * バイアス推定用のサンプルを1つ取り込む（静止中に周期的に呼ぶ）
+ * BIAS_SAMPLES個までは単純平均、それ以降は指数平均で追従する。
+ */
+void ImuSampler::calibrate()
+{
+  float raw = mReader();
+  float deviation = raw - mBias;
+
+  // 推定完了後は明らかな動きを除外（押下時の揺れなど）
+  if (mBiasCount >= BIAS_SAMPLES &&
+      (deviation > STILL_THRESHOLD_DPS || deviation < -STILL_THRESHOLD_DPS))
+  {
+    return;
+  }
+
+  if (mBiasCount < BIAS_SAMPLES)
+  {
+    mBiasCount++;
+    mBias += deviation / mBiasCount;
+  }
+  else
+  {
+    mBias += deviation * BIAS_TRACK_RATE;
+  }
+}
+
+/**
+ * バイアス推定完了状態取得
+ * @return true=推定完了, false=サンプル不足
+ */
+bool ImuSampler::isCalibrated() const
+{
+  return mBiasCount >= BIAS_SAMPLES;
+}
+
+/**
+ * バイアス補正済みのヨー角速度を取得する
+ * @return ヨー角速度 (deg/s、反時計回り正)
+ */
+float ImuSampler::sample()
+{
+  return mReader() - mBias;
+}
+
+/**
+ * 推定バイアス取得
+ * @return バイアス (deg/s)
+ */
+float ImuSampler::getBias() const
+{
+  return mBias;
+}
@@ -0,0 +1,181 @@
+#include "IterativeLearning.h"
+#include <stdio.h>
+#include <math.h>
+
+// 反復学習用定数定義
+const float IterativeLearning::BIN_CM = 5.0f;            // コースマップと同じ区間
+const float IterativeLearning::CORRECTION_SCALE = 2.0f;  // 0.5%刻み、±63%まで
+const float IterativeLearning::ERROR_SCALE = 4.0f;       // 0.25%刻み（補正の0.5%刻みより細かくする）
+const float IterativeLearning::LEARNING_GAIN = 0.5f;     // 数回の走行で収束する程度
+const float IterativeLearning::FORGETTING = 0.98f;       // 誤差がなければ約50回で半減
+
+IterativeLearning::IterativeLearning() : mCount(0),
+                                         mLap(0),
+                                         mRmsError(0.0f)
+{
+  for (int i = 0; i < MAX_BINS; i++)
+  {
+    mCorrection[i] = 0;
+  }
+  beginLap();
+}
+
+/**
+ * 前回までの補正を読み込む
+ * @param data 区間ごとの保存値
+ * @param count 区間数（MAX_BINSを超える分は捨てる）
+ * @param lap 学習済みの走行回数
+ */
+void IterativeLearning::load(const int8_t *data, int count, int lap)
+{
+  if (count > MAX_BINS) count = MAX_BINS;
+  for (int i = 0; i < MAX_BINS; i++)
+  {
+    mCorrection[i] = (i < count) ? data[i] : 0;
+  }
+  mCount = count;
+  mLap = lap;
+}
+
+/**
+ * 今回の誤差の記録を始める
+ */
+void IterativeLearning::beginLap()
+{
+  for (int i = 0; i < MAX_BINS; i++)
+  {
+    mErrorSum[i] = 0;
+    mSampleCount[i] = 0;
+  }
+}
+
+/**
+ * 追従誤差を記録する（トレース中に周期的に呼ぶ）
+ * @param distanceCm 走行距離 (cm)
+ * @param error 追従誤差（フィードバックが出した旋回量、正=左旋回）
+ */
+void IterativeLearning::record(float distanceCm, float error)
+{
+  int index = (int)(distanceCm / BIN_CM);
+  if (index < 0 || index >= MAX_BINS || mSampleCount[index] >= MAX_SAMPLES)
+  {
+    return;
+  }
+  if (error > 100.0f) error = 100.0f;
+  if (error < -100.0f) error = -100.0f;
+  // 切り捨てると小さい誤差が0になり、大きい誤差も0寄りに偏って学習が止まるので四捨五入する
+  mErrorSum[index] += (int16_t)lroundf(error * ERROR_SCALE);
+  mSampleCount[index]++;
+}
+
+/**
+ * 指定距離の補正旋回量を取得する
+ * @param distanceCm 走行距離 (cm)
+ * @return 補正旋回量 (%、正=左旋回、範囲外は0)
+ */
+float IterativeLearning::correctionAt(float distanceCm) const
+{
+  int index = (int)(distanceCm / BIN_CM);
+  if (index < 0 || index >= mCount)
+  {
+    return 0.0f;
+  }
+  return mCorrection[index] / CORRECTION_SCALE;
+}
+
+/**
+ * 今回の誤差から次回の補正を作る
+ * 応答遅れの分だけ先の区間の誤差を今の区間の補正に足し、隣の区間と平滑化して
+ * 高い周波数の誤差を学習しないようにする（学習の発散を防ぐ）。
+ */
+void IterativeLearning::finishLap()
+{
+  // 記録した区間数と誤差の大きさ
+  int recorded = 0;
+  float squareSum = 0.0f;
+  int samples = 0;
+  for (int i = 0; i < MAX_BINS; i++)
+  {
+    if (mSampleCount[i] > 0)
+    {
+      float error = errorAt(i);
+      squareSum += error * error;
+      samples++;
+      recorded = i + 1;
+    }
+  }
+  mRmsError = (samples > 0) ? sqrtf(squareSum / samples) : 0.0f;
+
+  // 3区間の平滑化（Qフィルタ）と忘却、量子化
+  // 平滑化前の値は前・今・次の3区間分だけ持ち、mCorrectionをその場で更新する
+  // （区間数分の作業配列をスタックに置かないため）
+  int count = (recorded > mCount) ? recorded : mCount;
+  float previous = updatedAt(0);
+  float current = previous;
+  for (int i = 0; i < count; i++)
+  {
+    float next = (i + 1 < count) ? updatedAt(i + 1) : current;
+    float value = FORGETTING * (previous + 2.0f * current + next) / 4.0f * CORRECTION_SCALE;
+    if (value > 127.0f) value = 127.0f;
+    if (value < -127.0f) value = -127.0f;
+    mCorrection[i] = (int8_t)(value + ((value < 0.0f) ? -0.5f : 0.5f));
+    previous = current;
+    current = next;
+  }
+  mCount = count;
+  mLap++;
+
+  printf("反復学習: %d回目の走行 誤差RMS %.2f%% 区間数 %d\n", mLap, mRmsError, mCount);
+  beginLap();
+}
+
+/**
+ * 今回の区間の誤差の平均を取得する
+ * @param index 区間番号
+ * @return 誤差（旋回量%、記録がなければ0）
+ */
+float IterativeLearning::errorAt(int index) const
+{
+  if (index >= MAX_BINS || mSampleCount[index] == 0)
+  {
+    return 0.0f;
+  }
+  return (float)mErrorSum[index] / ERROR_SCALE / mSampleCount[index];
+}
+
+/**
+ * 平滑化前の次回の補正を求める（今回の補正 + 学習ゲイン × 少し先の区間の誤差）
+ * @param index 区間番号
+ * @return 補正旋回量 (%)
+ */
+float IterativeLearning::updatedAt(int index) const
+{
+  return mCorrection[index] / CORRECTION_SCALE + LEARNING_GAIN * errorAt(index + LEAD_BINS);
+}
+
+/**
+ * 直近に終えた走行の誤差の二乗平均平方根を取得する（収束の確認用）
+ * @return 誤差RMS（旋回量%）
+ */
+float IterativeLearning::getRmsError() const
+{
+  return mRmsError;
+}
+
+/**
+ * LearningCorrectionData.hの形式で出力する（次の走行のためにビルドし直す）
+ */
+void IterativeLearning::dump() const
+{
+  printf("// ---- LearningCorrectionData.h ----\n");
+  printf("// 誤差RMS %.2f%%\n", mRmsError);
+  printf("static const int LEARNING_LAP = %d;\n", mLap);
+  printf("static const int LEARNING_BIN_COUNT = %d;\n", mCount);
+  printf("static const int8_t LEARNING_CORRECTION_DATA[] = {\n");
+  for (int i = 0; i < mCount; i++)
+  {
+    printf("%d,%s", mCorrection[i], (i % 16 == 15) ? "\n" : " ");
+  }
+  printf("0\n};\n");
+  printf("// ---- end ----\n");
+}
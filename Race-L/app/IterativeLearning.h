@@ -0,0 +1,44 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * 反復学習制御（走行距離ごとの操舵補正）
+ * 走行中に区間ごとの追従誤差（旋回量換算）の平均を記録し、走行終了時に
+ *   次回の補正 = 忘却係数 × 平滑化(今回の補正 + 学習ゲイン × 少し先の区間の誤差)
+ * で次の走行の補正を作る。補正はdump()でLearningCorrectionData.hの形式で出力し、
+ * 次のビルドで読み込む（実機に不揮発の保存先がないため）。
+ * メモリは区間数に比例して固定（1区間あたり4バイト）。
+ */
+class IterativeLearning {
+public:
+  static const int MAX_BINS = 400;            // 最大区間数（CourseMap::MAX_BINSと同じ）
+  static const float BIN_CM;                  // 1区間の長さ (cm、CourseMap::BIN_CMと同じ)
+
+  IterativeLearning();
+  void load(const int8_t *data, int count, int lap); // 前回までの補正を読み込む
+  void beginLap();                                   // 今回の誤差の記録を始める
+  void record(float distanceCm, float error);        // 追従誤差を記録（旋回量換算、正=左へ曲がるべき）
+  float correctionAt(float distanceCm) const;        // 指定距離の補正旋回量 (%、正=左旋回)
+  void finishLap();                                  // 今回の誤差から次回の補正を作る
+  float getRmsError() const;                         // 直近に終えた走行の誤差の二乗平均平方根
+  void dump() const;                                 // LearningCorrectionData.h形式で出力
+
+private:
+  static const float CORRECTION_SCALE;        // 保存値 = 補正旋回量[%] × CORRECTION_SCALE
+  static const float ERROR_SCALE;             // 誤差の合計の単位 = 旋回量[%] × ERROR_SCALE（四捨五入して足す）
+  static const float LEARNING_GAIN;           // 誤差に対する学習ゲイン
+  static const float FORGETTING;              // 忘却係数（誤差のない区間の補正を少しずつ戻す）
+  static const int LEAD_BINS = 1;             // 応答遅れ分だけ先の区間の誤差を使う
+  static const int MAX_SAMPLES = 80;          // 1区間で記録するサンプル数の上限（100 × ERROR_SCALE × 80 がint16_tに収まる）
+
+  float errorAt(int index) const;             // 今回の区間の誤差の平均
+  float updatedAt(int index) const;           // 平滑化前の次回の補正
+
+  int8_t mCorrection[MAX_BINS];   // 区間ごとの補正（量子化済み）
+  int16_t mErrorSum[MAX_BINS];    // 今回の区間ごとの誤差の合計（旋回量% × ERROR_SCALE）
+  uint8_t mSampleCount[MAX_BINS]; // 今回の区間ごとのサンプル数
+  int mCount;                     // 補正がある区間数
+  int mLap;                       // 学習済みの走行回数
+  float mRmsError;                // 直近に終えた走行の誤差の二乗平均平方根
+};
@@ -0,0 +1,112 @@
+#include "LineOffsetEstimator.h"
+#include <math.h>
+
+// 反射光モデル（黒と白の中間がTracer::targetになるように合わせる）
+const float LineOffsetEstimator::REFLECTION_BLACK = 5.0f;
+const float LineOffsetEstimator::REFLECTION_WHITE = 45.0f;
+const float LineOffsetEstimator::EDGE_WIDTH_CM = 1.0f;
+
+// ノイズ設定（実機のログに合わせて調整）
+const float LineOffsetEstimator::Q_OFFSET = 0.5f;
+const float LineOffsetEstimator::Q_HEADING = 0.5f;
+const float LineOffsetEstimator::R_REFLECTION = 4.0f;
+const float LineOffsetEstimator::MAX_OFFSET_CM = 3.0f;
+const float LineOffsetEstimator::SATURATION_RATIO = 0.1f;
+
+LineOffsetEstimator::LineOffsetEstimator()
+{
+  reset();
+}
+
+/**
+ * エッジ上・向きずれなしとして初期化する
+ */
+void LineOffsetEstimator::reset()
+{
+  mOffset = 0.0f;
+  mHeading = 0.0f;
+  mP00 = 0.25f;
+  mP01 = 0.0f;
+  mP11 = 0.05f;
+}
+
+/**
+ * 横ずれに対する反射光の予測値と傾きを求める
+ * @param offsetCm 横ずれ (cm、白地側が正)
+ * @param slope [out] 反射光の横ずれに対する傾き (1/cm)
+ * @return 反射光の予測値
+ */
+float LineOffsetEstimator::expectedReflection(float offsetCm, float &slope)
+{
+  float half = (REFLECTION_WHITE - REFLECTION_BLACK) / 2.0f;
+  float t = tanhf(offsetCm / EDGE_WIDTH_CM);
+  slope = half / EDGE_WIDTH_CM * (1.0f - t * t);
+  return REFLECTION_BLACK + half + half * t;
+}
+
+/**
+ * 予測と観測更新を1周期分行う
+ * @param reflection 反射光の測定値
+ * @param speedCms 車体速度 (cm/s)
+ * @param relativeYawRate 線に対する相対ヨーレート (rad/s、白地側へ向かう向きが正)
+ * @param dtSec 前回更新からの経過時間 (s)
+ */
+void LineOffsetEstimator::update(int reflection, float speedCms, float relativeYawRate, float dtSec)
+{
+  // 予測: y += v*psi*dt, psi += omega*dt
+  float a = speedCms * dtSec;   // F = [[1, a], [0, 1]]
+  mOffset += a * mHeading;
+  mHeading += relativeYawRate * dtSec;
+
+  // P = F P F^T + Q
+  float p00 = mP00 + 2.0f * a * mP01 + a * a * mP11 + Q_OFFSET * dtSec;
+  float p01 = mP01 + a * mP11;
+  float p11 = mP11 + Q_HEADING * dtSec;
+
+  // 観測更新: H = [slope, 0]（飽和域では傾きがほぼ0になり予測のまま進む）
+  float slope;
+  float innovation = reflection - expectedReflection(mOffset, slope);
+  float s = slope * slope * p00 + R_REFLECTION;
+  float k0 = p00 * slope / s;
+  float k1 = p01 * slope / s;
+
+  mOffset += k0 * innovation;
+  mHeading += k1 * innovation;
+  mP00 = p00 - k0 * slope * p00;
+  mP01 = p01 - k0 * slope * p01;
+  mP11 = p11 - k1 * slope * p01;
+
+  // 飽和域では観測が効かないため、黒/白のどちら側にいるかだけは観測に合わせる
+  float saturated = (REFLECTION_WHITE - REFLECTION_BLACK) * SATURATION_RATIO;
+  if (reflection > REFLECTION_WHITE - saturated && mOffset < EDGE_WIDTH_CM)
+  {
+    mOffset = EDGE_WIDTH_CM;
+    mP00 += mP11 * a * a; // 位置を補正した分だけ不確かさを残す
+  }
+  else if (reflection < REFLECTION_BLACK + saturated && mOffset > -EDGE_WIDTH_CM)
+  {
+    mOffset = -EDGE_WIDTH_CM;
+    mP00 += mP11 * a * a;
+  }
+
+  if (mOffset > MAX_OFFSET_CM) mOffset = MAX_OFFSET_CM;
+  if (mOffset < -MAX_OFFSET_CM) mOffset = -MAX_OFFSET_CM;
+}
+
+/**
+ * 横ずれ推定値取得
+ * @return 横ずれ (cm、白地側が正)
+ */
+float LineOffsetEstimator::getOffsetCm() const
+{
+  return mOffset;
+}
+
+/**
+ * 向きずれ推定値取得
+ * @return 向きずれ (rad、白地側へ向かう向きが正)
+ */
+float LineOffsetEstimator::getHeadingErrorRad() const
+{
+  return mHeading;
+}
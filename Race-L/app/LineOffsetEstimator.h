@@ -0,0 +1,33 @@
+#pragma once
+
+/**
+ * 線に対する横ずれ・向きずれの推定（拡張カルマンフィルタ）
+ * 状態は横ずれy (cm、白地側が正) と向きずれpsi (rad、白地側へ向かう向きが正) の2つ。
+ * 予測は車体速度と線に対する相対ヨーレート、観測は反射光の非線形モデル
+ * （黒〜白をtanhでつなぐ飽和特性）を使う。1回の更新は2x2行列の演算だけで済む。
+ */
+class LineOffsetEstimator {
+public:
+  LineOffsetEstimator();
+  void reset();                                                     // エッジ上・向きずれなしとして初期化
+  void update(int reflection, float speedCms, float relativeYawRate, float dtSec); // 予測＋観測更新
+  float getOffsetCm() const;                                        // 横ずれ推定値 (cm、白地側が正)
+  float getHeadingErrorRad() const;                                 // 向きずれ推定値 (rad、白地側へ向かう向きが正)
+  static float expectedReflection(float offsetCm, float &slope);    // 反射光モデル（傾きも返す）
+
+private:
+  static const float REFLECTION_BLACK;   // 黒線上の反射光
+  static const float REFLECTION_WHITE;   // 白地上の反射光
+  static const float EDGE_WIDTH_CM;      // 黒から白へ変化する幅の目安 (cm)
+  static const float Q_OFFSET;           // 横ずれのプロセスノイズ (cm^2/s)
+  static const float Q_HEADING;          // 向きずれのプロセスノイズ (rad^2/s)
+  static const float R_REFLECTION;       // 反射光の観測ノイズ分散
+  static const float MAX_OFFSET_CM;      // 推定値の上限（発散防止）
+  static const float SATURATION_RATIO;   // 黒/白の飽和とみなす反射光の範囲（黒白差に対する割合）
+
+  float mOffset;       // 横ずれ y
+  float mHeading;      // 向きずれ psi
+  float mP00;          // 誤差共分散 P[0][0]
+  float mP01;          // 誤差共分散 P[0][1] (=P[1][0])
+  float mP11;          // 誤差共分散 P[1][1]
+};
@@ -0,0 +1,104 @@
+#include "LineStatusEstimator.h"
+
+// 旋回方向の平滑化係数（1周期ごとの追従率）
+const float LineStatusEstimator::TURN_FILTER = 0.2f;
+
+LineStatusEstimator::LineStatusEstimator() : mState(State::ON_EDGE),
+                                             mLastEdgeTime(0),
+                                             mLastEdgeHeading(0.0f),
+                                             mFilteredTurn(0.0f)
+{
+}
+
+/**
+ * 現在をエッジ上として初期化する
+ * @param nowUs 現在時刻 (us)
+ * @param headingDeg 現在の向き (deg)
+ */
+void LineStatusEstimator::reset(uint64_t nowUs, float headingDeg)
+{
+  mState = State::ON_EDGE;
+  mLastEdgeTime = nowUs;
+  mLastEdgeHeading = headingDeg;
+  mFilteredTurn = 0.0f;
+}
+
+/**
+ * 1サンプルだけでライン上の位置を判定する
+ * @param diffReflection 反射光の目標値との差分
+ * @return ON_EDGE / ON_BLACK / ON_WHITE
+ */
+LineStatusEstimator::State LineStatusEstimator::classify(int diffReflection)
+{
+  if (diffReflection < BLACK_DIFF)
+  {
+    return State::ON_BLACK;
+  }
+  if (diffReflection > EDGE_BAND)
+  {
+    return State::ON_WHITE;
+  }
+  return State::ON_EDGE;
+}
+
+/**
+ * 1周期分の状態を更新する
+ * @param diffReflection 反射光の目標値との差分
+ * @param nowUs 現在時刻 (us)
+ * @param turn 直前の旋回量（正=左旋回）
+ * @param headingDeg 現在の向き (deg)
+ */
+void LineStatusEstimator::update(int diffReflection, uint64_t nowUs, float turn, float headingDeg)
+{
+  State state = classify(diffReflection);
+
+  if (state == State::ON_EDGE)
+  {
+    mLastEdgeTime = nowUs;
+    mLastEdgeHeading = headingDeg;
+    mFilteredTurn += (turn - mFilteredTurn) * TURN_FILTER;
+  }
+  else if (state == State::ON_WHITE && nowUs - mLastEdgeTime >= LOST_TIME_US)
+  {
+    state = State::LOST;
+  }
+
+  mState = state;
+}
+
+/**
+ * 現在の状態取得
+ * @return 状態
+ */
+LineStatusEstimator::State LineStatusEstimator::getState() const
+{
+  return mState;
+}
+
+/**
+ * 最後にエッジ上にいてからの時間取得
+ * @param nowUs 現在時刻 (us)
+ * @return 経過時間 (us)
+ */
+uint64_t LineStatusEstimator::getTimeSinceEdgeUs(uint64_t nowUs) const
+{
+  return nowUs - mLastEdgeTime;
+}
+
+/**
+ * 最後にエッジ上にいた時の向き取得
+ * @return 向き (deg)
+ */
+float LineStatusEstimator::getLastEdgeHeading() const
+{
+  return mLastEdgeHeading;
+}
+
+/**
+ * 最後にエッジ上にいた時の旋回方向取得
+ * @return +1=左旋回中, -1=右旋回中
+ */
+int LineStatusEstimator::getLastTurnSign() const
+{
+  return (mFilteredTurn < 0.0f) ? -1 : 1;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * ライン状態推定
+ * 反射光の目標値との差分から、エッジ上・黒線上・白地上・見失いを判定し、
+ * 最後にエッジ上にいた時刻・向き・旋回方向を保持する（復帰動作の手がかりにする）。
+ */
+class LineStatusEstimator {
+public:
+  enum class State {
+    ON_EDGE,   // エッジ上（トレース中）
+    ON_BLACK,  // 黒線上（内側に入り込んでいる）
+    ON_WHITE,  // 白地上（外れかけ）
+    LOST       // 白地上が続き見失った
+  };
+
+  LineStatusEstimator();
+  void reset(uint64_t nowUs, float headingDeg);              // 現在をエッジ上として初期化
+  void update(int diffReflection, uint64_t nowUs, float turn, float headingDeg); // 1周期分の更新
+  State getState() const;                                    // 現在の状態
+  uint64_t getTimeSinceEdgeUs(uint64_t nowUs) const;         // 最後にエッジ上にいてからの時間 (us)
+  float getLastEdgeHeading() const;                          // 最後にエッジ上にいた時の向き (deg)
+  int getLastTurnSign() const;                               // 最後にエッジ上にいた時の旋回方向 (+1=左, -1=右)
+  static State classify(int diffReflection);                 // 1サンプルだけでの判定（見失いは判定しない）
+
+private:
+  static const int EDGE_BAND = 10;          // エッジ上とみなす差分の幅
+  static const int BLACK_DIFF = -10;        // これ未満を黒線上とみなす差分
+  static const uint64_t LOST_TIME_US = 200 * 1000; // 白地上がこれ以上続いたら見失い
+  static const float TURN_FILTER;           // 旋回方向の平滑化係数
+
+  State mState;                 // 現在の状態
+  uint64_t mLastEdgeTime;       // 最後にエッジ上にいた時刻 (us)
+  float mLastEdgeHeading;       // 最後にエッジ上にいた時の向き (deg)
+  float mFilteredTurn;          // 平滑化した旋回量（エッジ上の間だけ更新）
+};
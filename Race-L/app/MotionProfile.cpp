@@ -0,0 +1,73 @@
+#include "MotionProfile.h"
+#include <math.h>
+
+MotionProfile::MotionProfile(float accel, float decel, float minSpeed, float latencySec)
+    : mAccel(accel),
+      mDecel(decel),
+      mMinSpeed(minSpeed),
+      mLatencySec(latencySec),
+      mDistance(0.0f),
+      mCruiseSpeed(0.0f)
+{
+}
+
+/**
+ * プロファイルを開始する
+ * @param distance 目標距離
+ * @param cruiseSpeed 巡航速度（最高速度）
+ */
+void MotionProfile::start(float distance, float cruiseSpeed)
+{
+  mDistance = distance;
+  mCruiseSpeed = (cruiseSpeed < mMinSpeed) ? mMinSpeed : cruiseSpeed;
+}
+
+/**
+ * 指定速度から停止するまでの予測距離を求める
+ * @param speed 現在速度
+ * @return 空走距離＋制動距離
+ */
+float MotionProfile::stoppingDistance(float speed) const
+{
+  return speed * mLatencySec + (speed * speed) / (2.0f * mDecel);
+}
+
+/**
+ * 走行済み距離に対する指令速度を求める
+ * @param traveled 走行済み距離
+ * @return 指令速度（目標距離到達後は0）
+ */
+float MotionProfile::speedAt(float traveled) const
+{
+  float remaining = mDistance - traveled;
+  if (remaining <= 0.0f)
+  {
+    return 0.0f;
+  }
+  if (traveled < 0.0f)
+  {
+    traveled = 0.0f;
+  }
+
+  // 加速区間: v = sqrt(vmin^2 + 2as)
+  float accelSpeed = sqrtf(mMinSpeed * mMinSpeed + 2.0f * mAccel * traveled);
+
+  // 減速区間: stoppingDistance(v) = remaining を満たすv（遅れ分だけ早めに減速開始）
+  float latencyTerm = mDecel * mLatencySec;
+  float decelSpeed = -latencyTerm + sqrtf(latencyTerm * latencyTerm + 2.0f * mDecel * remaining);
+
+  float speed = mCruiseSpeed;
+  if (accelSpeed < speed) speed = accelSpeed;
+  if (decelSpeed < speed) speed = decelSpeed;
+  if (speed < mMinSpeed) speed = mMinSpeed;
+  return speed;
+}
+
+/**
+ * 目標距離取得
+ * @return 目標距離
+ */
+float MotionProfile::getDistance() const
+{
+  return mDistance;
+}
@@ -0,0 +1,185 @@
+#include "MotionSupervisor.h"
+#include <stdio.h>
+
+const float MotionSupervisor::DISTANCE_MARGIN = 1.5f;       // スリップ・ヘディング終了の誤差を許容
+const float MotionSupervisor::DISTANCE_SLACK_DEG = 90.0f;   // 短い動作の余裕（約4cm）
+const float MotionSupervisor::TIME_MARGIN = 2.0f;           // 加減速・低電圧でも収まる程度
+const uint32_t MotionSupervisor::TIME_SLACK_US = 1000 * 1000;
+const float MotionSupervisor::MIN_CRUISE_DPS = 100.0f;      // MotionProfileの最低速度と合わせる
+const int MotionSupervisor::STALL_MIN_POWER = 30;           // 低速の指令では止まっていても判定しない
+const int32_t MotionSupervisor::STALL_MIN_DEG = 5;          // エンコーダの分解能＋ガタ
+const uint32_t MotionSupervisor::STALL_TIME_US = 300 * 1000; // 発進時の静止摩擦を越えるのに十分な時間
+
+MotionSupervisor::MotionSupervisor() : mName(""),
+                                       mStartTime(0),
+                                       mTimeBudgetUs(0),
+                                       mDistanceBudgetDeg(0.0f),
+                                       mLeftStartCount(0),
+                                       mRightStartCount(0),
+                                       mCause(Cause::NONE),
+                                       mElapsedUs(0),
+                                       mTraveledDeg(0.0f)
+{
+  mLeftWatch = {0, 0};
+  mRightWatch = {0, 0};
+}
+
+/**
+ * 動作の監視を開始する
+ * @param name 動作名（中断時の表示に使う）
+ * @param now 現在時刻 (us)
+ * @param timeBudgetUs 時間の上限 (us)
+ * @param distanceBudgetDeg 走行量の上限（回転角の大きい車輪, deg）
+ * @param leftCount 左エンコーダ値 (deg)
+ * @param rightCount 右エンコーダ値 (deg)
+ */
+void MotionSupervisor::begin(const char *name, SYSTIM now, uint32_t timeBudgetUs, float distanceBudgetDeg,
+                             int32_t leftCount, int32_t rightCount)
+{
+  mName = name;
+  mStartTime = now;
+  mTimeBudgetUs = timeBudgetUs;
+  mDistanceBudgetDeg = distanceBudgetDeg;
+  mLeftStartCount = leftCount;
+  mRightStartCount = rightCount;
+  mLeftWatch = {leftCount, now};
+  mRightWatch = {rightCount, now};
+  mCause = Cause::NONE;
+  mElapsedUs = 0;
+  mTraveledDeg = 0.0f;
+}
+
+/**
+ * 1周期分の判定を行う（一度中断と判定したら、次のbegin()まで同じ原因を返す）
+ * @param now 現在時刻 (us)
+ * @param leftCount 左エンコーダ値 (deg)
+ * @param rightCount 右エンコーダ値 (deg)
+ * @param leftPower 左車輪に出しているパワー (%)
+ * @param rightPower 右車輪に出しているパワー (%)
+ * @return 中断の原因（NONE=継続）
+ */
+MotionSupervisor::Cause MotionSupervisor::check(SYSTIM now, int32_t leftCount, int32_t rightCount,
+                                                int leftPower, int rightPower)
+{
+  if (mCause != Cause::NONE)
+  {
+    return mCause;
+  }
+
+  int32_t leftTraveled = leftCount - mLeftStartCount;
+  int32_t rightTraveled = rightCount - mRightStartCount;
+  if (leftTraveled < 0) leftTraveled = -leftTraveled;
+  if (rightTraveled < 0) rightTraveled = -rightTraveled;
+  float traveled = (float)((leftTraveled > rightTraveled) ? leftTraveled : rightTraveled);
+  uint32_t elapsed = (uint32_t)(now - mStartTime);
+
+  // 両輪とも判定する（片輪だけ引っかかった場合も検出する）
+  bool leftStalled = isStalled(mLeftWatch, now, leftCount, leftPower);
+  bool rightStalled = isStalled(mRightWatch, now, rightCount, rightPower);
+
+  if (leftStalled || rightStalled)
+  {
+    mCause = Cause::STALL;
+  }
+  else if (traveled > mDistanceBudgetDeg)
+  {
+    mCause = Cause::OVER_DISTANCE;
+  }
+  else if (elapsed > mTimeBudgetUs)
+  {
+    mCause = Cause::TIMEOUT;
+  }
+
+  if (mCause != Cause::NONE)
+  {
+    mElapsedUs = elapsed;
+    mTraveledDeg = traveled;
+  }
+  return mCause;
+}
+
+/**
+ * 1車輪のストールを判定する
+ * パワーがSTALL_MIN_POWER以上の間にSTALL_MIN_DEG回らない状態がSTALL_TIME_US続いたらストールとする。
+ * @param watch 判定区間
+ * @param now 現在時刻 (us)
+ * @param count エンコーダ値 (deg)
+ * @param power 出しているパワー (%)
+ * @return true=ストール
+ */
+bool MotionSupervisor::isStalled(WheelWatch &watch, SYSTIM now, int32_t count, int power)
+{
+  int32_t moved = count - watch.count;
+  if (moved < 0) moved = -moved;
+  if (power < 0) power = -power;
+
+  if (power < STALL_MIN_POWER || moved >= STALL_MIN_DEG)
+  {
+    // パワーが小さい・回っている間は判定区間を今からやり直す
+    watch.count = count;
+    watch.since = now;
+    return false;
+  }
+  return now - watch.since >= STALL_TIME_US;
+}
+
+/**
+ * 中断の原因を表示する
+ */
+void MotionSupervisor::report() const
+{
+  printf("動作中断[%s]: %s（経過 %lums / 上限 %lums, 走行 %.0fdeg / 上限 %.0fdeg）\n",
+         mName, causeName(mCause), (unsigned long)(mElapsedUs / 1000), (unsigned long)(mTimeBudgetUs / 1000),
+         mTraveledDeg, mDistanceBudgetDeg);
+}
+
+/**
+ * 中断の原因取得
+ * @return 中断の原因（NONE=中断なし）
+ */
+MotionSupervisor::Cause MotionSupervisor::getCause() const
+{
+  return mCause;
+}
+
+/**
+ * 監視中の動作名取得
+ * @return 動作名
+ */
+const char *MotionSupervisor::getName() const
+{
+  return mName;
+}
+
+/**
+ * 原因の表示名
+ * @param cause 原因
+ * @return 表示名
+ */
+const char *MotionSupervisor::causeName(Cause cause)
+{
+  switch (cause)
+  {
+  case Cause::TIMEOUT:
+    return "時間超過";
+  case Cause::OVER_DISTANCE:
+    return "走行量超過";
+  case Cause::STALL:
+    return "ストール";
+  default:
+    return "なし";
+  }
+}
+
+/**
+ * 走行量と巡航速度から時間の上限を求める
+ * @param distanceDeg 走行量（回転角の大きい車輪, deg）
+ * @param cruiseDps 巡航速度 (deg/s)
+ * @return 時間の上限 (us)
+ */
+uint32_t MotionSupervisor::timeBudgetUs(float distanceDeg, float cruiseDps)
+{
+  if (cruiseDps < 0.0f) cruiseDps = -cruiseDps;
+  if (cruiseDps < MIN_CRUISE_DPS) cruiseDps = MIN_CRUISE_DPS;
+  return (uint32_t)(distanceDeg / cruiseDps * TIME_MARGIN * 1.0e6f) + TIME_SLACK_US;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+// mpc_gain_gen で生成した予測操舵のゲイン（手で編集しない）
+// 予測区間 10周期, 周期 0.050s, 応答時定数 0.050s, 重み 横ずれ 1.00 向きずれ 20.00 指令 0.50
+static const int MPC_HORIZON = 10;
+static const float MPC_DT_SEC = 0.050f;
+static const int MPC_SPEED_COUNT = 6;
+static const float MPC_SPEEDS_CMS[MPC_SPEED_COUNT] = {5.0f, 10.0f, 20.0f, 30.0f, 40.0f, 50.0f};
+// 状態ゲイン {Ky (rad/s/cm), Kpsi (1/s), Komega}
+static const float MPC_STATE_GAINS[MPC_SPEED_COUNT][3] = {
+  {-0.409878f, -5.843383f, 0.266882f},
+  {-0.724267f, -6.735697f, 0.299792f},
+  {-1.013853f, -8.903155f, 0.378756f},
+  {-1.064215f, -10.702706f, 0.442403f},
+  {-1.050732f, -12.129085f, 0.490858f},
+  {-1.027168f, -13.347668f, 0.530680f},
+};
+// 曲率の先読みゲイン (rad/s per 1/cm、k周期先)
+static const float MPC_PREVIEW_GAINS[MPC_SPEED_COUNT][MPC_HORIZON] = {
+  {-1.4480f, -1.2845f, -1.0093f, -0.7497f, -0.5386f, -0.3767f, -0.2553f, -0.1647f, -0.0962f, -0.0431f},
+  {-3.2773f, -2.8309f, -2.1813f, -1.5839f, -1.1033f, -0.7383f, -0.4700f, -0.2775f, -0.1431f, -0.0535f},
+  {-8.3962f, -6.9027f, -5.1031f, -3.5196f, -2.2759f, -1.3587f, -0.7167f, -0.2967f, -0.0553f, 0.0375f},
+  {-14.8568f, -11.8062f, -8.4315f, -5.5456f, -3.3356f, -1.7635f, -0.7244f, -0.1086f, 0.1757f, 0.1965f},
+  {-22.1567f, -17.1462f, -11.8616f, -7.4417f, -4.1466f, -1.8980f, -0.5087f, 0.2209f, 0.4638f, 0.3558f},
+  {-30.1593f, -22.8028f, -15.2909f, -9.1306f, -4.6643f, -1.7520f, -0.0868f, 0.6593f, 0.7750f, 0.4932f},
+};
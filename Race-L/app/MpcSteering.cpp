@@ -0,0 +1,52 @@
+#include "MpcSteering.h"
+#include "MpcGainTable.h"
+
+const int MpcSteering::HORIZON = MPC_HORIZON;
+const float MpcSteering::DT_SEC = MPC_DT_SEC;
+
+static_assert(MPC_HORIZON <= MpcSteering::MAX_HORIZON, "MpcGainTable.hの予測区間が長すぎます");
+
+/**
+ * 次の周期のヨーレート指令を求める
+ * @param offsetCm 横ずれ (cm、白地側が正)
+ * @param headingRad 向きずれ (rad、白地側へ向かう向きが正)
+ * @param yawRate 現在のヨーレート (rad/s、線のある側へ曲がる向きが正)
+ * @param speedCms 車体速度 (cm/s)
+ * @param curvature k周期先の線の曲率 (1/cm、線のある側へ曲がる向きが正、HORIZON個)
+ * @param maxYawRate ヨーレート指令の上限 (rad/s)
+ * @return ヨーレート指令 (rad/s、線のある側へ曲がる向きが正)
+ */
+float MpcSteering::compute(float offsetCm, float headingRad, float yawRate, float speedCms,
+                           const float *curvature, float maxYawRate)
+{
+  // 速度の格子で挟む2点と補間係数（範囲外は端の値）
+  int upper = 1;
+  while (upper < MPC_SPEED_COUNT - 1 && MPC_SPEEDS_CMS[upper] < speedCms)
+  {
+    upper++;
+  }
+  int lower = upper - 1;
+  float ratio = (speedCms - MPC_SPEEDS_CMS[lower]) / (MPC_SPEEDS_CMS[upper] - MPC_SPEEDS_CMS[lower]);
+  if (ratio < 0.0f) ratio = 0.0f;
+  if (ratio > 1.0f) ratio = 1.0f;
+
+  // 2点それぞれの線形則を評価して補間する
+  float command[2];
+  const int rows[2] = {lower, upper};
+  for (int i = 0; i < 2; i++)
+  {
+    const float *stateGain = MPC_STATE_GAINS[rows[i]];
+    const float *previewGain = MPC_PREVIEW_GAINS[rows[i]];
+    float u = -(stateGain[0] * offsetCm + stateGain[1] * headingRad + stateGain[2] * yawRate);
+    for (int k = 0; k < MPC_HORIZON; k++)
+    {
+      u -= previewGain[k] * curvature[k];
+    }
+    command[i] = u;
+  }
+  float yawCommand = command[0] + (command[1] - command[0]) * ratio;
+
+  if (yawCommand > maxYawRate) yawCommand = maxYawRate;
+  if (yawCommand < -maxYawRate) yawCommand = -maxYawRate;
+  return yawCommand;
+}
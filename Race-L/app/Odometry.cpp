@@ -0,0 +1,114 @@
+#include "Odometry.h"
+#include "DiffDrive.h"
+#include <math.h>
+
+// スリップによるエンコーダの誤差を長く持ち込まないよう長めにする
+// （バイアスの残りによる定常誤差は 残りのバイアス×時定数 程度、0.1deg/sで1deg）
+const float Odometry::FUSION_TIME_CONSTANT_SEC = 10.0f;
+
+Odometry::Odometry() : mLastLeftCount(0),
+                       mLastRightCount(0),
+                       mLastGyroHeadingDeg(0.0f),
+                       mHasGyroReference(false),
+                       mEncoderHeadingDeg(0.0f),
+                       mHeadingDeg(0.0f),
+                       mDistanceCm(0.0f),
+                       mXCm(0.0f),
+                       mYCm(0.0f)
+{
+}
+
+/**
+ * 現在のエンコーダ値を原点として推定をやり直す
+ * @param leftCount 左エンコーダ値 (deg)
+ * @param rightCount 右エンコーダ値 (deg)
+ */
+void Odometry::reset(int32_t leftCount, int32_t rightCount)
+{
+  mLastLeftCount = leftCount;
+  mLastRightCount = rightCount;
+  mHasGyroReference = false;
+  mEncoderHeadingDeg = 0.0f;
+  mHeadingDeg = 0.0f;
+  mDistanceCm = 0.0f;
+  mXCm = 0.0f;
+  mYCm = 0.0f;
+}
+
+/**
+ * 推定を更新する
+ * 向きは前回の向きにジャイロ積分角の変化を足したもの（高域）と、エンコーダの向き（低域）を
+ * 時定数FUSION_TIME_CONSTANT_SECの相補フィルタで混ぜる。ジャイロの変化は積分済みの角度の差なので、
+ * 更新の間隔が空いても途中の回転を取りこぼさない（dtSec=0ならジャイロの変化だけを足す）。
+ * @param leftCount 左エンコーダ値 (deg)
+ * @param rightCount 右エンコーダ値 (deg)
+ * @param gyroHeadingDeg ジャイロのヨー角速度を積分した角度 (deg、反時計回り正、原点は任意)
+ * @param gyroValid true=ジャイロ値を使う, false=エンコーダのみで推定
+ * @param dtSec 前回更新からの経過時間 (s)
+ */
+void Odometry::update(int32_t leftCount, int32_t rightCount, float gyroHeadingDeg, bool gyroValid, float dtSec)
+{
+  float leftDeg = (float)(leftCount - mLastLeftCount);
+  float rightDeg = (float)(rightCount - mLastRightCount);
+  mLastLeftCount = leftCount;
+  mLastRightCount = rightCount;
+
+  float encoderDelta = DiffDrive::headingDeg(leftDeg, rightDeg);
+  mEncoderHeadingDeg += encoderDelta;
+
+  // ジャイロが使えない間（最初の1回を含む）はエンコーダの変化で進める
+  float headingDelta = encoderDelta;
+  if (gyroValid && mHasGyroReference)
+  {
+    float alpha = FUSION_TIME_CONSTANT_SEC / (FUSION_TIME_CONSTANT_SEC + dtSec);
+    float fused = alpha * (mHeadingDeg + (gyroHeadingDeg - mLastGyroHeadingDeg)) +
+                  (1.0f - alpha) * mEncoderHeadingDeg;
+    headingDelta = fused - mHeadingDeg;
+  }
+  mLastGyroHeadingDeg = gyroHeadingDeg;
+  mHasGyroReference = gyroValid;
+
+  // 区間の中間の向きで位置を積分
+  float distanceCm = DiffDrive::degToCm((leftDeg + rightDeg) / 2.0f);
+  float midHeadingRad = (mHeadingDeg + headingDelta / 2.0f) * 3.14159265f / 180.0f;
+  mXCm += distanceCm * cosf(midHeadingRad);
+  mYCm += distanceCm * sinf(midHeadingRad);
+  mDistanceCm += distanceCm;
+  mHeadingDeg += headingDelta;
+}
+
+/**
+ * 向き取得
+ * @return 向き (deg、反時計回り正、開始時0)
+ */
+float Odometry::getHeadingDeg() const
+{
+  return mHeadingDeg;
+}
+
+/**
+ * 累積走行距離取得
+ * @return 走行距離 (cm)
+ */
+float Odometry::getDistanceCm() const
+{
+  return mDistanceCm;
+}
+
+/**
+ * 位置X取得
+ * @return 開始時の前方方向の位置 (cm)
+ */
+float Odometry::getXCm() const
+{
+  return mXCm;
+}
+
+/**
+ * 位置Y取得
+ * @return 開始時の左方向の位置 (cm)
+ */
+float Odometry::getYCm() const
+{
+  return mYCm;
+}
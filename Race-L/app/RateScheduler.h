@@ -0,0 +1,45 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * レートグループ（何tickごとに、何tick目に実行するか）
+ */
+struct RateGroup {
+  uint16_t periodTicks;   // 実行周期 (tick)
+  uint16_t phaseTicks;    // 位相 (tick、0〜periodTicks-1)
+};
+
+/**
+ * 静的なレートグループスケジューラ
+ * 周期ハンドラで起動される1tickごとにadvance()を呼び、各グループが今回のtickで
+ * 実行対象かをisDue()で判定する。位相をずらして重い処理が同じtickに重ならないようにし、
+ * 重ならないことはcollides()でコンパイル時に確認できる。
+ */
+class RateScheduler {
+public:
+  RateScheduler(const RateGroup *groups, int count);
+  void advance();                   // 1tick進める
+  bool isDue(int group) const;      // 今回のtickで実行するか
+  uint32_t getTick() const;         // 現在のtick
+
+  /**
+   * 2つのグループが同じtickで実行されることがあるか
+   * t ≡ phaseA (mod periodA) かつ t ≡ phaseB (mod periodB) の解があるのは、
+   * 位相の差が周期の最大公約数で割り切れるとき。
+   */
+  static constexpr bool collides(const RateGroup &a, const RateGroup &b)
+  {
+    return ((a.phaseTicks - b.phaseTicks) % gcd(a.periodTicks, b.periodTicks)) == 0;
+  }
+
+private:
+  static constexpr int gcd(int a, int b)
+  {
+    return (b == 0) ? a : gcd(b, a % b);
+  }
+
+  const RateGroup *mGroups;   // グループ表
+  int mCount;                 // グループ数
+  uint32_t mTick;             // 現在のtick（最初のadvance()で0）
+};
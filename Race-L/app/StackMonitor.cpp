@@ -0,0 +1,50 @@
+#include "StackMonitor.h"
+#include <stdio.h>
+
+const STK_T StackMonitor::PAINT_PATTERN = (STK_T)0xA5A5A5A5; // 通常の変数・戻り番地に現れにくい値
+
+/**
+ * スタック領域を埋める
+ * タスクの起動前（ATT_INIの初期化ルーチン）に呼ぶ。起動後に呼ぶと使用中の領域を壊す。
+ * @param stack スタック領域の先頭
+ * @param sizeBytes スタック領域の大きさ (byte)
+ */
+void StackMonitor::paint(STK_T *stack, size_t sizeBytes)
+{
+  size_t words = sizeBytes / sizeof(STK_T);
+  for (size_t i = 0; i < words; i++)
+  {
+    stack[i] = PAINT_PATTERN;
+  }
+}
+
+/**
+ * 最大使用量を求める（先頭から埋めた値が続く範囲を未使用とみなす）
+ * @param stack スタック領域の先頭
+ * @param sizeBytes スタック領域の大きさ (byte)
+ * @return 最大使用量 (byte)
+ */
+size_t StackMonitor::measureUsed(const STK_T *stack, size_t sizeBytes)
+{
+  size_t words = sizeBytes / sizeof(STK_T);
+  size_t unused = 0;
+  while (unused < words && stack[unused] == PAINT_PATTERN)
+  {
+    unused++;
+  }
+  return (words - unused) * sizeof(STK_T);
+}
+
+/**
+ * 使用量を出力する
+ * 未使用の部分が残っていない場合は、溢れて領域の外を壊した可能性がある。
+ * @param name 表示名
+ * @param stack スタック領域の先頭
+ * @param sizeBytes スタック領域の大きさ (byte)
+ */
+void StackMonitor::print(const char *name, const STK_T *stack, size_t sizeBytes)
+{
+  size_t used = measureUsed(stack, sizeBytes);
+  printf("[stack] %s: 最大 %u / %u byte (%u%%)%s\n", name, (unsigned)used, (unsigned)sizeBytes,
+         (unsigned)(used * 100 / sizeBytes), (used >= sizeBytes) ? " 溢れの可能性あり" : "");
+}
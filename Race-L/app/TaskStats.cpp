@@ -0,0 +1,105 @@
+#include "TaskStats.h"
+#include <stdio.h>
+
+/**
+ * コンストラクタ
+ * @param name 表示名
+ * @param periodUs 起動周期 (us)
+ */
+TaskStats::TaskStats(const char *name, uint32_t periodUs) : mName(name),
+                                                            mPeriodUs(periodUs)
+{
+  reset();
+}
+
+/**
+ * 集計をやり直す
+ */
+void TaskStats::reset()
+{
+  mCount = 0;
+  mStartUs = 0;
+  mLastStartUs = 0;
+  mMinExecUs = UINT32_MAX;
+  mMaxExecUs = 0;
+  mTotalExecUs = 0;
+  mMaxJitterUs = 0;
+  mJitterValid = false;
+  mBlockingCount = 0;
+  mMaxBlockingUs = 0;
+}
+
+/**
+ * 1回分の処理開始を記録する
+ * @param nowUs 現在時刻 (us、32bitで一周しても差分は正しく求まる)
+ */
+void TaskStats::begin(uint32_t nowUs)
+{
+  if (mJitterValid)
+  {
+    uint32_t interval = nowUs - mLastStartUs;
+    uint32_t jitter = (interval > mPeriodUs) ? interval - mPeriodUs : mPeriodUs - interval;
+    if (jitter > mMaxJitterUs) mMaxJitterUs = jitter;
+  }
+  mLastStartUs = nowUs;
+  mStartUs = nowUs;
+  mJitterValid = true;
+}
+
+/**
+ * 1回分の処理終了を記録する
+ * @param nowUs 現在時刻 (us)
+ */
+void TaskStats::end(uint32_t nowUs)
+{
+  uint32_t exec = nowUs - mStartUs;
+  if (exec < mMinExecUs) mMinExecUs = exec;
+  if (exec > mMaxExecUs) mMaxExecUs = exec;
+  mTotalExecUs += exec;
+  mCount++;
+}
+
+/**
+ * 待ちを伴う1回分の処理終了を記録する
+ * 実行時間は周期処理の集計に含めず、回数と最大時間だけを別に数える。
+ * 待っている間は次の起動が遅れるので、次回の起動間隔も周期ずれに含めない。
+ * @param nowUs 現在時刻 (us)
+ */
+void TaskStats::endBlocking(uint32_t nowUs)
+{
+  uint32_t exec = nowUs - mStartUs;
+  if (exec > mMaxBlockingUs) mMaxBlockingUs = exec;
+  mBlockingCount++;
+  mJitterValid = false;
+}
+
+/**
+ * 集計結果を出力する
+ */
+void TaskStats::print() const
+{
+  if (mCount == 0)
+  {
+    printf("[%s] 実行なし\n", mName);
+  }
+  else
+  {
+    printf("[%s] 回数 %lu 実行時間 最小 %luus 平均 %luus 最大 %luus 周期ずれ最大 %luus\n",
+           mName, (unsigned long)mCount, (unsigned long)mMinExecUs,
+           (unsigned long)(mTotalExecUs / mCount), (unsigned long)mMaxExecUs, (unsigned long)mMaxJitterUs);
+  }
+  if (mBlockingCount > 0)
+  {
+    printf("[%s] 待ちを伴う実行 回数 %lu 最大 %luus（上の集計には含めない）\n",
+           mName, (unsigned long)mBlockingCount, (unsigned long)mMaxBlockingUs);
+  }
+}
+
+/**
+ * 最大実行時間を取得する
+ * @return 最大実行時間 (us)
+ */
+uint32_t TaskStats::getMaxExecUs() const
+{
+  return mMaxExecUs;
+}
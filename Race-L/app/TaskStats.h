@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * タスクの実行時間・起動周期の統計
+ * 起動ごとにbegin()/end()で時刻 (us) を渡すと、実行時間の最小・最大・平均と
+ * 起動間隔の最大ずれ（周期に対するジッタ）を集計する。
+ * 待ちを伴う動作をした回はend()の代わりにendBlocking()を呼び、回数と最大時間を別に数える
+ * （秒単位の待ち時間で周期処理の実行時間が埋もれないように）。
+ */
+class TaskStats {
+public:
+  TaskStats(const char *name, uint32_t periodUs);
+  void begin(uint32_t nowUs);      // 1回分の処理開始
+  void end(uint32_t nowUs);        // 1回分の処理終了
+  void endBlocking(uint32_t nowUs); // 待ちを伴う1回分の処理終了（周期処理の集計には含めない）
+  void reset();                    // 集計をやり直す
+  void print() const;              // 集計結果を出力
+  uint32_t getMaxExecUs() const;   // 最大実行時間 (us)
+
+private:
+  const char *mName;         // 表示名
+  uint32_t mPeriodUs;        // 周期 (us)
+  uint32_t mCount;           // 実行回数
+  uint32_t mStartUs;         // 今回の開始時刻
+  uint32_t mLastStartUs;     // 前回の開始時刻
+  uint32_t mMinExecUs;       // 最小実行時間
+  uint32_t mMaxExecUs;       // 最大実行時間
+  uint64_t mTotalExecUs;     // 実行時間の合計
+  uint32_t mMaxJitterUs;     // 起動間隔と周期の差の最大
+  bool mJitterValid;         // 前回の開始時刻から周期ずれを求められる（待ちを伴う回の直後は求めない）
+  uint32_t mBlockingCount;   // 待ちを伴う実行の回数
+  uint32_t mMaxBlockingUs;   // 待ちを伴う実行の最大時間
+};
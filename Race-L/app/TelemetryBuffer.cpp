@@ -0,0 +1,68 @@
+#include "TelemetryBuffer.h"
+#include <stdio.h>
+
+static_assert((TelemetryBuffer::CAPACITY & (TelemetryBuffer::CAPACITY - 1)) == 0, "CAPACITYは2のべき乗にすること");
+
+TelemetryBuffer::TelemetryBuffer() : mWritten(0),
+                                     mRead(0),
+                                     mDropped(0)
+{
+}
+
+/**
+ * 1件記録する（満杯なら記録せずに捨てた件数を数える）
+ * 記録を書いてから通算件数を公開するので、出力側は書きかけの記録を読まない。
+ * @param record 記録
+ */
+void TelemetryBuffer::push(const TelemetryRecord &record)
+{
+  uint32_t written = mWritten.load(std::memory_order_relaxed);
+  if (written - mRead.load(std::memory_order_acquire) >= (uint32_t)CAPACITY)
+  {
+    mDropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  mRecords[written % CAPACITY] = record;
+  mWritten.store(written + 1, std::memory_order_release);
+}
+
+/**
+ * 古い順に出力する
+ * 1回の出力件数を制限して、出力するタスクの実行時間を抑える。
+ * 1件出力するごとに通算件数を進め、その分の領域を書き込み側に返す。
+ * @param maxRecords 最大出力件数
+ * @return 出力した件数
+ */
+int TelemetryBuffer::flush(int maxRecords)
+{
+  uint32_t read = mRead.load(std::memory_order_relaxed);
+  uint32_t written = mWritten.load(std::memory_order_acquire);
+  int printed = 0;
+  while (read != written && printed < maxRecords)
+  {
+    const TelemetryRecord &r = mRecords[read % CAPACITY];
+    printf("T %lu %d %d %d %d\n", (unsigned long)r.tick, r.distanceMm, r.diff, r.turnX10, r.speed);
+    read++;
+    mRead.store(read, std::memory_order_release);
+    printed++;
+  }
+  return printed;
+}
+
+/**
+ * 未出力の件数を取得する
+ * @return 件数
+ */
+int TelemetryBuffer::getCount() const
+{
+  return (int)(mWritten.load(std::memory_order_acquire) - mRead.load(std::memory_order_acquire));
+}
+
+/**
+ * 溢れて捨てた件数を取得する
+ * @return 件数
+ */
+uint32_t TelemetryBuffer::getDropped() const
+{
+  return mDropped.load(std::memory_order_relaxed);
+}
@@ -1,56 +1,217 @@
 #include "Tracer.h"
 #include <stdio.h>
+#include <math.h>
 #include <cstdlib> // abs関数のため
+#include "spike/hub/battery.h"
+#include "spike/hub/imu.h"
+#include "CourseMapData.h"
+#include "SpeedProfileTable.h"
+#include "LearningCorrectionData.h"
 
 // etrobo_tr方式の定数定義
-const float Tracer::Kp = 0.8;  // 比例定数（オーバーシュート防止）
-const float Tracer::Kd = 0.2;  // 微分定数（変化率抑制）
-const int Tracer::bias = 0;    // バイアス
 const int Tracer::target = 25; // 目標値（黒と白の中間値）
 
+// レートグループ（基本周期TRACER_PERIOD_US=50msのtick単位）
+// 初期処理のステップ時間はtick数で数えているため、基本周期は変えずに振り分ける
+static constexpr RateGroup RATE_GROUPS[] = {
+  {1, 0},    // RATE_CONTROL：毎tick（色の判定もスナップショットを読むだけなのでここで行う）
+  {4, 2},    // RATE_SUPERVISE：200ms
+};
+
 // 青色検知用定数定義
 const int Tracer::BLUE_THRESHOLD = 120;      // 青色判定閾値
 const int Tracer::COLOR_DIFF_THRESHOLD = 50; // 他色との差の閾値
 
-// 前進制御用定数
-const float Tracer::WHEEL_DIAMETER_CM = 5.4f; // ホイール直径（実機に合わせて調整）
+// コースマップによる速度計画用定数（実機に合わせて調整）
+const float Tracer::REPLAY_LAT_ACCEL_CMS2 = 60.0f;  // 半径20cmで約35cm/s
+const float Tracer::REPLAY_DECEL_CMS2 = 80.0f;      // 減速度
+const float Tracer::REPLAY_LOOKAHEAD_CM = 60.0f;    // 先読み距離
+
+// ライン復帰用定数
+const float Tracer::RECOVERY_TOLERANCE_DEG = 3.0f;  // 目標の向きの許容誤差
+const float Tracer::SWEEP_START_DEG = 15.0f;        // 初期振り幅
+const float Tracer::SWEEP_STEP_DEG = 15.0f;         // 振り幅の増分
+const float Tracer::SWEEP_MAX_DEG = 120.0f;         // 振り幅の上限
+
+// エッジ切り替え用定数
+const float Tracer::EDGE_SWITCH_MAX_CM = 15.0f; // これだけ進んでも横切れなければ中止
+
+// 走行動作の監視
+const float Tracer::BLACK_SEARCH_MAX_CM = 60.0f; // 青色マーカーから黒線までの距離より十分長く
+
+// 状態フィードバック用定数（50ms周期で安定する範囲の極配置）
+const float Tracer::SF_NATURAL_FREQ = 4.0f;       // 約0.4秒で横ずれを戻す
+const float Tracer::SF_DAMPING = 0.8f;            // オーバーシュートを抑える
+const float Tracer::SF_MIN_SPEED_CMS = 10.0f;     // 低速でゲインが過大にならないように
+const float Tracer::WHEEL_RESPONSE_SEC = 0.05f;   // 指令から車輪速度が追従するまでの時定数（mpc_gain_genの--lagと合わせる）
+const float Tracer::MPC_MAX_TURN = 60.0f;         // 外側車輪が飽和しない程度
+
+// 反射光校正（掃引）用定数
+const float Tracer::CAL_SWEEP_DEG = 30.0f;           // センサ位置で約±4cm
+const float Tracer::CAL_SENSOR_DISTANCE_CM = 8.0f;   // 車軸中心からセンサまで
+
+// 曲率フィードフォワード用定数
+const float Tracer::FF_GAIN = 1.0f;         // 理論値に対する倍率
+const float Tracer::FF_PREVIEW_CM = 3.0f;   // 先読み距離（センサ位置＋応答遅れ）
+
+// 速度プロファイル用定数（スリップしない範囲で調整）
+const float Tracer::PROFILE_ACCEL_DPS2 = 2000.0f;    // 約0.25秒で500deg/sに到達
+const float Tracer::PROFILE_DECEL_DPS2 = 2500.0f;    // 減速度
+const float Tracer::PROFILE_MIN_SPEED_DPS = 100.0f;  // 最低速度
+const float Tracer::PROFILE_LATENCY_SEC = 0.02f;     // 応答遅れ（制御周期＋モーター応答）
+
+// 左右同期制御用定数
+const float Tracer::SYNC_GAIN_PER_SEC = 5.0f;          // 10degの遅れで50deg/s補正
+const float Tracer::SYNC_MAX_CORRECTION_DPS = 150.0f;  // 補正上限
+
+// IMU用定数（ハブの取り付け向きに合わせて調整）
+const float Tracer::IMU_YAW_SIGN = 1.0f;
 
 Tracer::Tracer() : leftWheel(EPort::PORT_B, Motor::EDirection::COUNTERCLOCKWISE, true),
                    rightWheel(EPort::PORT_A, Motor::EDirection::CLOCKWISE, true),
                    colorSensor(EPort::PORT_E),
+                   mActuator(leftWheel, rightWheel),
+                   mMoveProfile(PROFILE_ACCEL_DPS2, PROFILE_DECEL_DPS2, PROFILE_MIN_SPEED_DPS, PROFILE_LATENCY_SEC),
+                   mImu(readHubYawRate),
+                   mScheduler(RATE_GROUPS, RATE_GROUP_COUNT),
+                   mBatteryMv(0),                         // 監視周期で取得
                    
                    mPreviousError(0),
+                   mGains(GainSchedule::lookup(0.0f, DEFAULT_BASE_SPEED)), // 開始区間・通常速度のゲイン
                    mIsInitialized(false),
                    mLineTraceEnabled(true),              // デフォルトでライントレース有効
                    mBlueDetectionEnabled(true),          // デフォルトで青色検知有効
                    mBlueDetectionCount(0),               // 青色検知回数初期化
                    mCurrentBaseSpeed(DEFAULT_BASE_SPEED), // 初期速度設定
                    mIsStopped(false),                     // 停止フラグ初期化
+                   mEventNotifier(NULL),                  // 通知先なし
                    mInitialSequenceCompleted(false),     // 初期処理未完了
-                   mInitialStartTime(0)                   // 初期処理開始時刻初期化
+                   mInitialStartTime(0),                  // 初期処理開始時刻初期化
+                   mLastDriveTime(0),                     // 速度制御未実施
+                   mLastOdometryTime(0),                  // オドメトリ未更新
+                   mGyroHeadingDeg(0.0f),
+                   mLastGyroTime(0),                      // ジャイロ未積分
+                   mMotionAborted(false),
+                   mMotionAbortCount(0),
+                   mBlockedInRun(false),
+                   mRecoveryPhase(RecoveryPhase::NONE),   // 復帰動作なし
+                   mLastTurn(0.0f),
+                   mSearchCenterHeading(0.0f),
+                   mSearchTargetHeading(0.0f),
+                   mSweepAmplitude(0.0f),
+                   mSweepSign(1),
+                   mRecoveryStartTime(0),
+                   mTraceEdge(INITIAL_TRACE_EDGE),        // 開始時のエッジ
+                   mLastEstimateTime(0)                   // 横ずれ推定未実施
 {
+  static_assert(sizeof(RATE_GROUPS) / sizeof(RATE_GROUPS[0]) == RATE_GROUP_COUNT, "RATE_GROUPSとRateGroupIdの数が違う");
 }
 
 void Tracer::init()
 {
   leftWheel.resetCount();
   rightWheel.resetCount();
+  mOdometry.reset(0, 0);
+  mLastOdometryTime = 0;
+  mRecordedMap.clear();
+  mReplayMap.load(COURSE_MAP_DATA, COURSE_MAP_BIN_COUNT);
+  mLearning.load(LEARNING_CORRECTION_DATA, LEARNING_BIN_COUNT, LEARNING_LAP);
+  mLearning.beginLap();
+  resetLineStatus();
   mIsInitialized = true;
 }
 
+/**
+ * 走行開始前の準備
+ * エンコーダのリセット・コースマップ等の読み込みとバッテリー電圧の取得を押下前に済ませ、
+ * 押下後の最初のrun()ですぐにモーター指令を出せるようにする。
+ */
+void Tracer::arm()
+{
+  init();
+  mBatteryMv = hub_battery_get_voltage();
+  printf("走行準備完了\n");
+}
+
 void Tracer::terminate()
 {
-  leftWheel.stop();
-  rightWheel.stop();
+  stopWheels();
+}
+
+/**
+ * 走行ログを出力する
+ * 制御タスクが記録した分を、優先度の低いmain_taskの待ちループから出力する
+ * （printfが遅れても制御周期に影響しない）。1回の件数はTELEMETRY_FLUSH_MAXまで。
+ */
+void Tracer::flushTelemetry()
+{
+  mTelemetry.flush(TELEMETRY_FLUSH_MAX);
+}
+
+/**
+ * 走行終了の処理
+ * 完全停止の通知を受けた側が、周期ハンドラを止めて制御タスクが起動されなくなってから呼ぶ
+ * （制御タスクより低い優先度のタスクから呼べば、制御タスクと同時には動かない）。
+ * 最後のモーター指令を1回だけ出し、走行ログの残りと、記録したコースマップ・学習結果を出力する。
+ */
+void Tracer::finish()
+{
+  mActuator.invalidate(); // 前回値によらず必ず書き込む
+  stopWheels(FINISH_STOP_MODE);
+
+  mTelemetry.flush(TelemetryBuffer::CAPACITY);
+  if (mTelemetry.getDropped() > 0)
+  {
+    printf("走行ログ: 溢れて捨てた件数 %lu\n", (unsigned long)mTelemetry.getDropped());
+  }
+  mOvershoot.print();
+  // 今回の走行で記録したコースマップを出力（CourseMapData.hに貼り付けて再走行に使う）
+  mRecordedMap.dump();
+  // 次の走行の操舵補正を作って出力（LearningCorrectionData.hに貼り付ける）
+  if (LEARNING_ENABLED)
+  {
+    mLearning.finishLap();
+    mLearning.dump();
+  }
+}
+
+/**
+ * 制御タスクの中で条件が成立するまで待つ
+ * 待ちを伴う動作をしたことを記録し、その回のrun()の実行時間を周期処理の統計から分けられるようにする。
+ * @param name 表示名（NULL=表示しない）
+ * @param condition 条件関数（bool()、trueで待ち終了）
+ * @param timeoutUs タイムアウト (us、WaitUntil::FOREVER=なし)
+ * @param pollUs 条件を評価する周期 (us)
+ * @return 結果
+ */
+template <typename Condition>
+WaitResult Tracer::waitMotion(const char *name, Condition condition, uint32_t timeoutUs, uint32_t pollUs)
+{
+  mBlockedInRun = true;
+  return WaitUntil::run(name, condition, timeoutUs, pollUs);
 }
 
 void Tracer::run()
 {
+  mBlockedInRun = false;
   if (!mIsInitialized)
   {
     init();
   }
 
+  mScheduler.advance();
+
+  // 向き・位置の推定を更新し、コースマップを記録
+  updateOdometry();
+  mRecordedMap.record(mOdometry.getDistanceCm(), mOdometry.getHeadingDeg());
+
+  // 低い周期のグループ
+  // 走行ログの出力（printf）は制御周期に入れず、main_taskのflushTelemetry()で行う
+  if (mScheduler.isDue(RATE_SUPERVISE))
+  {
+    updateSupervision();
+  }
+
   // 初期処理が未完了の場合は初期処理を実行
   if (!mInitialSequenceCompleted)
   {
@@ -59,98 +220,570 @@ void Tracer::run()
   }
 
   // 完全停止フラグチェック
+  // （main_taskが周期ハンドラを止めるまでの間だけ呼ばれる。停止指令は前回と同じなので書き込まれない）
   if (mIsStopped) {
-    leftWheel.stop();
-    rightWheel.stop();
+    stopWheels(FINISH_STOP_MODE);
     return; // 停止状態を維持
   }
 
-  // 青色検知チェック
+  // 青色検知チェック（毎tick。間引くとマーカーの上を通り過ぎる間に見逃しやすい）
   if (mBlueDetectionEnabled && detectBlue())
   {
-    mBlueDetectionCount++; // 検知回数をカウント
-    printf("青色を検知しました! 回数: %d\n", mBlueDetectionCount);
+    handleBlueDetection();
+    return; // 青色検知時は処理を終了
+  }
 
-    // 1回目の青色検知後に速度を下げる
-    if (mBlueDetectionCount == 1)
-    {
-      setSlowMode(true);
-      printf("1回目の青色検知後、低速モードに切り替えました\n");
-    }
+  // ライントレースが無効の場合は処理をスキップ
+  if (!mLineTraceEnabled)
+  {
+    return;
+  }
+
+  // etrobo_tr方式のライントレース処理
+  traceLine();
+}
 
-    // 青色検知を無効にする（処理中の重複防止）
-    setBlueDetectionEnabled(false);
+/**
+ * 青色検知時の処理
+ * 検知回数に応じた動作を実行し、完全停止でなければライントレースを再開する。
+ */
+void Tracer::handleBlueDetection()
+{
+  mBlueDetectionCount++; // 検知回数をカウント
+  printf("青色を検知しました! 回数: %d\n", mBlueDetectionCount);
 
-    // ライントレースを無効にする
-    setLineTraceEnabled(false);
+  // 1回目の青色検知後に速度を下げる
+  if (mBlueDetectionCount == 1)
+  {
+    setSlowMode(true);
+    printf("1回目の青色検知後、低速モードに切り替えました\n");
+  }
 
-    // 検知回数に応じた動作実行
-    executeBlueAction();
+  // 青色検知を無効にする（処理中の重複防止）
+  setBlueDetectionEnabled(false);
 
-    // 完全停止が設定されていない場合のみライントレースを再開
-    if (!mIsStopped) {
-      // 青色検知とライントレースを再び有効にする
-      setBlueDetectionEnabled(true);
-      setLineTraceEnabled(true);
-      printf("ライントレース再開\n");
-    } else {
-      printf("完全停止状態を維持\n");
-    }
+  // ライントレースを無効にする
+  setLineTraceEnabled(false);
 
-    return; // 青色検知時は処理を終了
+  notify(Event::PHASE_CHANGED);
+
+  // 検知回数に応じた動作実行
+  executeBlueAction();
+
+  // 完全停止が設定されていない場合のみライントレースを再開
+  if (!mIsStopped) {
+    // 青色検知とライントレースを再び有効にする
+    setBlueDetectionEnabled(true);
+    setLineTraceEnabled(true);
+    printf("ライントレース再開\n");
+
+    // 走行後にライン上にいなければ、現在の向きを中心にすぐ探索を始める
+    resetLineStatus();
+    if (LineStatusEstimator::classify(calDiffReflection()) == LineStatusEstimator::State::ON_WHITE)
+    {
+      startRecovery(false);
+    }
+  } else {
+    printf("完全停止状態を維持\n");
   }
+}
 
-  // ライントレースが無効の場合は処理をスキップ
-  if (!mLineTraceEnabled)
+/**
+ * 監視周期の処理
+ * 毎回の速度制御で読んでいたバッテリー電圧を、ここでまとめて更新する。
+ */
+void Tracer::updateSupervision()
+{
+  mBatteryMv = hub_battery_get_voltage();
+}
+
+/**
+ * ライントレースを1周期分実行する
+ * PD制御（フィードバック）に、反復学習の補正とコースマップの曲率によるフィードフォワードを加える。
+ */
+void Tracer::traceLine()
+{
+  int diffReflection = calDiffReflection();
+
+  // ライン状態推定（見失っていれば復帰動作を優先）
+  if (updateLineStatus(diffReflection))
   {
     return;
   }
 
-  // etrobo_tr方式のライントレース処理
-  int diffReflection = calDiffReflection();
+  // 現在の区間・計画速度のゲインを選ぶ
+  // （旋回量で下げた後の速度で選ぶと、減速→ゲイン変化→旋回量の変化が速度に戻ってしまう）
+  mGains = GainSchedule::lookup(mOdometry.getDistanceCm(), calcPlannedBaseSpeed());
 
-  // PD制御による操作量計算
-  float turn = calcPropValue(diffReflection);
+  // 操舵量計算（PD制御、推定状態のフィードバック、予測操舵のいずれか）
+  float turn;
+  switch (STEERING_MODE)
+  {
+  case SteeringMode::STATE_FEEDBACK:
+    turn = calcStateFeedback();
+    break;
+  case SteeringMode::MPC:
+    turn = calcMpcSteering();
+    break;
+  default:
+    turn = calcPropValue(diffReflection);
+    break;
+  }
 
   // 適応的速度計算
   int adaptiveSpeed = calcAdaptiveSpeed(turn);
 
+  // 反復学習：フィードバックが出した旋回量を誤差として記録し、前回までに学習した補正を足す
+  if (LEARNING_ENABLED)
+  {
+    float distance = mOdometry.getDistanceCm();
+    mLearning.record(distance, turn - mGains.bias);
+    turn += mLearning.correctionAt(distance);
+  }
+
+  // 曲率フィードフォワード（PDは残りの偏差だけを補正する、予測操舵は曲率を織り込み済み）
+  if (STEERING_MODE != SteeringMode::MPC)
+  {
+    turn += calcCurvatureFeedForward(adaptiveSpeed);
+  }
+
+  // 走行ログ（出力は走行ログのグループでまとめて行う）
+  TelemetryRecord record;
+  record.tick = mScheduler.getTick();
+  record.distanceMm = (int16_t)(mOdometry.getDistanceCm() * 10.0f);
+  record.diff = diffReflection;
+  record.turnX10 = (int16_t)(turn * 10.0f);
+  record.speed = adaptiveSpeed;
+  mTelemetry.push(record);
+
   // モーター制御
+  mLastTurn = turn;
   int pwm_l = adaptiveSpeed - turn;
   int pwm_r = adaptiveSpeed + turn;
-  leftWheel.setPower(pwm_l);
-  rightWheel.setPower(pwm_r);
+  driveWheels(pwm_l, pwm_r);
+}
+
+/**
+ * ライン状態を更新し、必要なら復帰動作を行う
+ * 見失ったら最後にエッジ上にいた向きへ戻ってから探索する。
+ * 復帰動作中にエッジか黒線を見つけたらトレースに戻る。
+ * @param diffReflection 反射光の目標値との差分
+ * @retval true 復帰動作中（この周期のトレースは行わない） / false 通常トレース
+ */
+bool Tracer::updateLineStatus(int diffReflection)
+{
+  SYSTIM now;
+  get_tim(&now);
+  mLineStatus.update(diffReflection, now, mLastTurn, mOdometry.getHeadingDeg());
+  LineStatusEstimator::State state = mLineStatus.getState();
+
+  if (mRecoveryPhase != RecoveryPhase::NONE)
+  {
+    if (state == LineStatusEstimator::State::ON_EDGE || state == LineStatusEstimator::State::ON_BLACK)
+    {
+      printf("ライン復帰: %lums\n", (unsigned long)((now - mRecoveryStartTime) / 1000));
+      mRecoveryPhase = RecoveryPhase::NONE;
+      mPreviousError = diffReflection; // D項の跳ねを防ぐ
+      mLineOffset.reset();
+      return false;
+    }
+    continueRecovery();
+    return true;
+  }
+
+  if (state == LineStatusEstimator::State::LOST)
+  {
+    printf("ライン喪失: 最後のエッジから%lums\n", (unsigned long)(mLineStatus.getTimeSinceEdgeUs(now) / 1000));
+    startRecovery(true);
+    continueRecovery();
+    return true;
+  }
+  return false;
+}
+
+/**
+ * ライン状態を現在地点基準でやり直す（スクリプト走行の後など、過去のエッジ情報が使えない時）
+ */
+void Tracer::resetLineStatus()
+{
+  SYSTIM now;
+  get_tim(&now);
+  mLineStatus.reset(now, mOdometry.getHeadingDeg());
+  mLineOffset.reset();
+  mRecoveryPhase = RecoveryPhase::NONE;
+}
+
+/**
+ * トレースするエッジを設定する
+ * 線の上でセンサがすでに反対側の縁にある場合など、線を横切らずに切り替える時に使う。
+ * D項の前回値とライン状態は新しいエッジ基準でやり直す。
+ * @param edge トレースするエッジ
+ */
+void Tracer::setTraceEdge(TraceEdge edge)
+{
+  mTraceEdge = edge;
+  mPreviousError = calDiffReflection(); // D項の跳ねを防ぐ
+  resetLineStatus();
+  printf("トレースエッジ: %s\n", (edge == TraceEdge::LEFT) ? "LEFT" : "RIGHT");
+}
+
+/**
+ * トレース中のエッジを取得する
+ * @return トレース中のエッジ
+ */
+Tracer::TraceEdge Tracer::getTraceEdge() const
+{
+  return mTraceEdge;
+}
+
+/**
+ * トレース中のエッジから見て線のある側を取得する
+ * @return +1=左手に線（右エッジ）, -1=右手に線（左エッジ）
+ */
+int Tracer::getLineSideSign() const
+{
+  return (mTraceEdge == TraceEdge::RIGHT) ? 1 : -1;
+}
+
+/**
+ * 線を横切って反対側のエッジへ移る
+ * 線のある側へ緩く曲がりながら進み、黒線上を通過して反対側の白地に出たら
+ * トレースするエッジを切り替える。EDGE_SWITCH_MAX_CM進んでも横切れなければ中止する。
+ * 時間・走行量・ストールは他の走行動作と同じく監視し、同じ一連の動作の中で前の動作が
+ * 中断されていた場合は何もしない。動作スクリプト（executeBlueAction()など）から呼ぶ。
+ * @retval true 切り替え完了 / false 横切れず中止・中断（エッジはそのまま）
+ */
+bool Tracer::switchEdge()
+{
+  if (mMotionAborted)
+  {
+    printf("前の動作が中断されたため省略\n");
+    return false;
+  }
+
+  int lineSide = getLineSideSign();
+  int innerSpeed = EDGE_SWITCH_SPEED * EDGE_SWITCH_INNER_PCT / 100;
+  int leftSpeed = (lineSide > 0) ? innerSpeed : EDGE_SWITCH_SPEED;
+  int rightSpeed = (lineSide > 0) ? EDGE_SWITCH_SPEED : innerSpeed;
+
+  float startDistance = mOdometry.getDistanceCm();
+  bool seenBlack = false;
+  bool crossed = false;
+
+  beginSupervision("エッジ切り替え", MOTION_TIMEOUT_US,
+                   DiffDrive::cmToDeg(EDGE_SWITCH_MAX_CM) * MotionSupervisor::DISTANCE_MARGIN);
+  waitMotion("エッジ切り替え", [&]() {
+    updateOdometry();
+    if (mOdometry.getDistanceCm() - startDistance >= EDGE_SWITCH_MAX_CM || !superviseMotion())
+    {
+      return true; // 横切れなかった
+    }
+    LineStatusEstimator::State state = LineStatusEstimator::classify(calDiffReflection());
+    if (state == LineStatusEstimator::State::ON_BLACK)
+    {
+      seenBlack = true;
+    }
+    else if (seenBlack && state == LineStatusEstimator::State::ON_WHITE)
+    {
+      crossed = true;
+      return true;
+    }
+    driveWheels(leftSpeed, rightSpeed);
+    return false;
+  }, WaitUntil::FOREVER, SPEED_CONTROL_PERIOD_US);
+  stopWheels();
+
+  if (!crossed)
+  {
+    printf("エッジ切り替え失敗: 線を横切れませんでした\n");
+    return false;
+  }
+
+  setTraceEdge((mTraceEdge == TraceEdge::RIGHT) ? TraceEdge::LEFT : TraceEdge::RIGHT);
+  return true;
+}
+
+/**
+ * ライン復帰動作を開始する
+ * @param turnBack true=最後にエッジ上にいた向きへ戻ってから最後の旋回方向に探索,
+ *                 false=現在の向きを中心に線のある側から探索
+ */
+void Tracer::startRecovery(bool turnBack)
+{
+  get_tim(&mRecoveryStartTime);
+  mSweepAmplitude = SWEEP_START_DEG;
+
+  if (turnBack)
+  {
+    // 最短経路：見失ってから回った分だけ戻る
+    mRecoveryPhase = RecoveryPhase::TURN_BACK;
+    mSweepSign = mLineStatus.getLastTurnSign();
+    mSearchCenterHeading = mLineStatus.getLastEdgeHeading();
+    mSearchTargetHeading = mSearchCenterHeading;
+  }
+  else
+  {
+    // トレース中のエッジから見て線のある側から探索を始める
+    mRecoveryPhase = RecoveryPhase::SWEEP;
+    mSweepSign = getLineSideSign();
+    mSearchCenterHeading = mOdometry.getHeadingDeg();
+    mSearchTargetHeading = mSearchCenterHeading + mSweepSign * mSweepAmplitude;
+  }
+}
+
+/**
+ * ライン復帰動作を1周期分実行する（目標の向きへその場旋回し、達したら次の目標へ）
+ */
+void Tracer::continueRecovery()
+{
+  float error = mSearchTargetHeading - mOdometry.getHeadingDeg();
+
+  if (error < RECOVERY_TOLERANCE_DEG && error > -RECOVERY_TOLERANCE_DEG)
+  {
+    if (mRecoveryPhase == RecoveryPhase::TURN_BACK)
+    {
+      // 戻り終えたら最後の旋回方向から探索
+      mRecoveryPhase = RecoveryPhase::SWEEP;
+    }
+    else
+    {
+      // 折り返して振り幅を広げる
+      mSweepSign = -mSweepSign;
+      if (mSweepAmplitude + SWEEP_STEP_DEG <= SWEEP_MAX_DEG)
+      {
+        mSweepAmplitude += SWEEP_STEP_DEG;
+      }
+    }
+    mSearchTargetHeading = mSearchCenterHeading + mSweepSign * mSweepAmplitude;
+    error = mSearchTargetHeading - mOdometry.getHeadingDeg();
+  }
+
+  int speed = (error > 0.0f) ? RECOVERY_SPEED : -RECOVERY_SPEED;
+  driveWheels(-speed, speed);
+}
+
+/**
+ * コースマップの曲率から旋回量のフィードフォワード項を計算する
+ * 曲率kの円弧を速度vで走るには左右車輪の速度差 k×トレッド×v が必要なので、
+ * 旋回量（左右差の半分）は k×トレッド/2×v となる。
+ * @param speed 現在の基本速度（パワー%換算）
+ * @return 旋回量（正=左旋回、コースマップがなければ0）
+ */
+float Tracer::calcCurvatureFeedForward(int speed) const
+{
+  if (mReplayMap.getBinCount() == 0)
+  {
+    return 0.0f;
+  }
+
+  // センサ位置と応答遅れの分だけ先の曲率を使う
+  float curvature = mReplayMap.curvatureAt(mOdometry.getDistanceCm() + FF_PREVIEW_CM);
+  return FF_GAIN * curvature * (DiffDrive::TRACK_WIDTH_CM / 2.0f) * speed;
 }
 
 /**
  * 反射光の差分を計算する
+ * 反射光の校正済みなら、横ずれに比例するよう線形化した差分を返す。
  * @return ライン境界とセンサ値との差分
  */
 int Tracer::calDiffReflection() const
 {
-  int diff = colorSensor.getReflection() - target;
+  int diff = mReflectionLinearizer.linearize(readSensors().reflection, target);
   return diff;
 }
 
+/**
+ * センサの最新値を取得する
+ * センシングタスクが書き込んだスナップショットを待たずに読む。
+ * センシングタスクの起動前（校正中など）は直接読む。
+ * @return センサ値
+ */
+SensorSnapshot Tracer::readSensors() const
+{
+  SensorSnapshot snapshot;
+  if (!mSensorBuffer.read(snapshot))
+  {
+    readSensorsDirect(snapshot);
+  }
+  return snapshot;
+}
+
+/**
+ * センサを直接読む
+ * @param snapshot [out] センサ値
+ */
+void Tracer::readSensorsDirect(SensorSnapshot &snapshot) const
+{
+  SYSTIM now;
+  get_tim(&now);
+  snapshot.timeUs = now;
+
+  spikeapi::ColorSensor::RGB rgb;
+  colorSensor.getRGB(rgb);
+  snapshot.red = rgb.r;
+  snapshot.green = rgb.g;
+  snapshot.blue = rgb.b;
+  snapshot.reflection = colorSensor.getReflection();
+
+  snapshot.leftCount = leftWheel.getCount();
+  snapshot.rightCount = rightWheel.getCount();
+  snapshot.leftSpeed = leftWheel.getSpeed();
+  snapshot.rightSpeed = rightWheel.getSpeed();
+
+  // ジャイロの積分はセンシングタスクだけが行う（直接読む場合は積分済みの値を返し、使わない）
+  snapshot.gyroHeadingDeg = mGyroHeadingDeg;
+  snapshot.gyroValid = false;
+}
+
+/**
+ * センサをまとめて読み、スナップショットを更新する
+ * センシングタスク（制御タスクより高い優先度・短い周期）から呼ぶ。
+ * RGBの読み出しなど時間のかかるI/Oを制御タスクから切り離す。
+ */
+void Tracer::sampleSensors()
+{
+  SensorSnapshot snapshot;
+  readSensorsDirect(snapshot);
+  integrateGyro(snapshot);
+  mSensorBuffer.publish(snapshot);
+}
+
+/**
+ * ジャイロのヨー角速度を読み、センシングタスクの周期で積分する
+ * バイアス推定が済むまでは積分しない（制御タスクは周期の長さに関係なく積分済みの角度の差を使う）。
+ * @param snapshot [in,out] 読み出し時刻を使い、積分した角度を書き込む
+ */
+void Tracer::integrateGyro(SensorSnapshot &snapshot)
+{
+  if (!mImu.isCalibrated())
+  {
+    return;
+  }
+  float rateDps = mImu.sample();
+  if (mLastGyroTime != 0)
+  {
+    mGyroHeadingDeg += rateDps * (snapshot.timeUs - mLastGyroTime) * 1.0e-6f;
+  }
+  mLastGyroTime = snapshot.timeUs;
+  snapshot.gyroHeadingDeg = mGyroHeadingDeg;
+  snapshot.gyroValid = true;
+}
+
 /**
  * PD制御による操作量を計算する
+ * ゲインはtraceLine()で選んだ区間・速度のもの（GainScheduleTable.h）を使う。
  * @param diffReflection ライン境界との差分
- * @return 操作量
+ * @return 操作量（正=左旋回）
  */
 float Tracer::calcPropValue(int diffReflection)
 {
   // P制御（比例制御）
-  float pTerm = Kp * diffReflection;
+  float pTerm = mGains.kp * diffReflection;
 
   // D制御（微分制御）- オーバーシュートを防ぐ
-  float dTerm = Kd * (diffReflection - mPreviousError);
+  float dTerm = mGains.kd * (diffReflection - mPreviousError);
   mPreviousError = diffReflection;
 
-  float turn = pTerm + dTerm + bias;
+  // 白側にずれたら線のある側へ曲がる（エッジによって旋回方向が逆になる）
+  float turn = getLineSideSign() * (pTerm + dTerm) + mGains.bias;
 
   return turn;
 }
 
+/**
+ * 横ずれ・向きずれの推定値による状態フィードバックで操作量を計算する
+ * 反射光の飽和域でも推定値は連続的に変化し、向きずれを微分の代わりに使える。
+ * @return 操作量（正=左旋回）
+ */
+float Tracer::calcStateFeedback()
+{
+  float yawRate;
+  float speedCms = updateLineOffset(yawRate);
+  if (speedCms < SF_MIN_SPEED_CMS) speedCms = SF_MIN_SPEED_CMS;
+
+  float yawPerTurn = calcYawRatePerTurn();
+
+  // y'' = v*omega に対して固有角振動数・減衰比を合わせる（速度に応じてゲインを変える）
+  float offsetGain = SF_NATURAL_FREQ * SF_NATURAL_FREQ / (speedCms * yawPerTurn);
+  float headingGain = 2.0f * SF_DAMPING * SF_NATURAL_FREQ / yawPerTurn;
+
+  // 白地側へのずれ・白地側への向きは線のある側へ曲がって戻す
+  float feedback = offsetGain * mLineOffset.getOffsetCm() +
+                   headingGain * mLineOffset.getHeadingErrorRad();
+  return getLineSideSign() * feedback + mGains.bias;
+}
+
+/**
+ * 予測操舵で操作量を計算する
+ * 横ずれ・向きずれの推定値、車体のヨーレート、予測区間分の線の曲率（コースマップ）から
+ * 事前計算したゲインで次の周期のヨーレート指令を求め、旋回量に換算する。
+ * @return 操作量（正=左旋回）
+ */
+float Tracer::calcMpcSteering()
+{
+  float yawRate;
+  float speedCms = updateLineOffset(yawRate);
+  int lineSide = getLineSideSign();
+
+  // 予測区間の各周期で到達する地点の曲率（線のある側へ曲がる向きを正に）
+  float curvature[MpcSteering::MAX_HORIZON];
+  float distance = mOdometry.getDistanceCm() + FF_PREVIEW_CM;
+  for (int k = 0; k < MpcSteering::HORIZON; k++)
+  {
+    curvature[k] = lineSide * mReplayMap.curvatureAt(distance + speedCms * MpcSteering::DT_SEC * k);
+  }
+
+  float yawPerTurn = calcYawRatePerTurn();
+  float yawCommand = MpcSteering::compute(mLineOffset.getOffsetCm(), mLineOffset.getHeadingErrorRad(),
+                                          lineSide * yawRate, speedCms, curvature,
+                                          MPC_MAX_TURN * yawPerTurn);
+  return lineSide * yawCommand / yawPerTurn + mGains.bias;
+}
+
+/**
+ * 旋回量1%あたりのヨーレートを求める（左右の速度差は旋回量の2倍）
+ * @return ヨーレート (rad/s、正=左旋回)
+ */
+float Tracer::calcYawRatePerTurn()
+{
+  return DiffDrive::headingDeg(0.0f, WheelSpeedController::toDegPerSec(2.0f)) * 3.14159265f / 180.0f;
+}
+
+/**
+ * 横ずれ・向きずれの推定を1周期分更新する
+ * 線に対する相対ヨーレートは、エンコーダの左右速度差に前回の旋回指令への応答遅れ分を
+ * 見込んだ車体のヨーレートと、コースマップの線の曲率から求める。
+ * @param yawRate [out] 車体のヨーレート (rad/s、正=左旋回)
+ * @return 車体速度 (cm/s)
+ */
+float Tracer::updateLineOffset(float &yawRate)
+{
+  SYSTIM now;
+  get_tim(&now);
+  float dtSec = (mLastEstimateTime == 0) ? 0.0f : (now - mLastEstimateTime) * 1.0e-6f;
+  mLastEstimateTime = now;
+
+  // 車体速度とヨーレート（エンコーダ）
+  SensorSnapshot sensors = readSensors();
+  float leftDps = sensors.leftSpeed;
+  float rightDps = sensors.rightSpeed;
+  float speedCms = DiffDrive::degToCm((leftDps + rightDps) / 2.0f);
+  float measuredYaw = DiffDrive::headingDeg(leftDps, rightDps) * 3.14159265f / 180.0f;
+
+  // 前回の旋回指令に一次遅れで近づく分を見込む
+  float commandedYaw = mLastTurn * calcYawRatePerTurn();
+  float response = dtSec / (WHEEL_RESPONSE_SEC + dtSec);
+  yawRate = measuredYaw + (commandedYaw - measuredYaw) * response;
+
+  // 線の曲がりに対する相対ヨーレート（白地側へ向かう向きを正に）
+  float lineCurvature = mReplayMap.curvatureAt(mOdometry.getDistanceCm());
+  float relativeYawRate = getLineSideSign() * (speedCms * lineCurvature - yawRate);
+
+  // 推定器は反射光の非線形モデルを持つので、線形化前の反射光を渡す
+  mLineOffset.update(sensors.reflection, speedCms, relativeYawRate, dtSec);
+  return speedCms;
+}
+
 /**
  * 適応的速度を計算する（etrobo_tr方式）
  * @param turn 旋回量
@@ -158,6 +791,9 @@ float Tracer::calcPropValue(int diffReflection)
  */
 int Tracer::calcAdaptiveSpeed(float turn)
 {
+  // コースマップがあればカーブ手前で予め減速した速度を基本にする
+  int baseSpeed = calcPlannedBaseSpeed();
+
   // 旋回量の絶対値が大きいほど速度を下げる
   float turnAbs = abs(turn);
 
@@ -170,18 +806,54 @@ int Tracer::calcAdaptiveSpeed(float turn)
   else if (turnAbs > 15)
   {
     // 中程度のカーブ: 中程度減速（50%）
-    return (mCurrentBaseSpeed * 50) / 100;
+    return (baseSpeed * 50) / 100;
   }
   else if (turnAbs > 8)
   {
     // 軽いカーブ: 軽度減速（70%）
-    return (mCurrentBaseSpeed * 70) / 100;
+    return (baseSpeed * 70) / 100;
   }
   else
   {
     // 直線: 現在の基本速度
+    return baseSpeed;
+  }
+}
+
+/**
+ * コースマップによる基本速度を計算する
+ * オフラインで生成した速度プロファイル（SpeedProfileTable.h）があれば走行距離から表を引く。
+ * なければ記録済みコースマップから、通常速度の区間では直線でREPLAY_MAX_SPEEDまで上げ、
+ * カーブ手前では横加速度と減速度の制限から逆算した速度まで予め落とす。
+ * どちらもない場合は現在の基本速度をそのまま返す。低速モード中は上限を変えない。
+ * @return 基本速度（パワー%換算）
+ */
+int Tracer::calcPlannedBaseSpeed() const
+{
+  if (SPEED_PROFILE_BIN_COUNT > 0)
+  {
+    int index = (int)(mOdometry.getDistanceCm() / SPEED_PROFILE_BIN_CM);
+    if (index < 0) index = 0;
+    if (index >= SPEED_PROFILE_BIN_COUNT) index = SPEED_PROFILE_BIN_COUNT - 1;
+    int speed = SPEED_PROFILE_TABLE[index];
+    if (mCurrentBaseSpeed != DEFAULT_BASE_SPEED && speed > mCurrentBaseSpeed)
+    {
+      speed = mCurrentBaseSpeed;
+    }
+    return speed;
+  }
+
+  if (mReplayMap.getBinCount() == 0)
+  {
     return mCurrentBaseSpeed;
   }
+
+  int maxSpeed = (mCurrentBaseSpeed == DEFAULT_BASE_SPEED) ? REPLAY_MAX_SPEED : mCurrentBaseSpeed;
+  float maxSpeedCms = DiffDrive::degToCm(WheelSpeedController::toDegPerSec(maxSpeed));
+  float limitCms = mReplayMap.speedLimitAt(mOdometry.getDistanceCm(), maxSpeedCms,
+                                           REPLAY_LAT_ACCEL_CMS2, REPLAY_DECEL_CMS2, REPLAY_LOOKAHEAD_CM);
+  int speed = (int)WheelSpeedController::fromDegPerSec(DiffDrive::cmToDeg(limitCms));
+  return (speed < MIN_SPEED) ? MIN_SPEED : speed;
 }
 
 /**
@@ -190,106 +862,425 @@ int Tracer::calcAdaptiveSpeed(float turn)
  */
 bool Tracer::detectBlue() const
 {
-  spikeapi::ColorSensor::RGB rgb;
-  colorSensor.getRGB(rgb);
+  SensorSnapshot sensors = readSensors();
 
   // 青色の条件：
   // 1. 青の値が閾値以上
   // 2. 青が赤より一定以上大きい
   // 3. 青が緑より一定以上大きい
-  bool isBlue = (rgb.b > BLUE_THRESHOLD) &&
-                (rgb.b > rgb.r + COLOR_DIFF_THRESHOLD) &&
-                (rgb.b > rgb.g + COLOR_DIFF_THRESHOLD);
+  bool isBlue = (sensors.blue > BLUE_THRESHOLD) &&
+                (sensors.blue > sensors.red + COLOR_DIFF_THRESHOLD) &&
+                (sensors.blue > sensors.green + COLOR_DIFF_THRESHOLD);
 
   return isBlue;
 }
 
 /**
- * 指定距離を前進する
- * @param distanceCm 前進距離（cm）
+ * 左右車輪に速度を指令する（エンコーダ速度による閉ループ制御）
+ * 前回制御からSPEED_CONTROL_PERIOD_US未満の呼び出しは出力を更新しない
+ * @param leftSpeed 左車輪の指令速度（パワー%換算）
+ * @param rightSpeed 右車輪の指令速度（パワー%換算）
  */
-void Tracer::moveForward(float distanceCm, TurnDirection direction, float turnIntensity)
+void Tracer::driveWheels(int leftSpeed, int rightSpeed)
 {
-  const char *dirName = (direction == TurnDirection::LEFT) ? "LEFT" : (direction == TurnDirection::RIGHT) ? "RIGHT"
-                                                                                                          : "STRAIGHT";
+  SYSTIM now;
+  get_tim(&now);
 
-  // 開始時のエンコーダ値を個別に記録
-  int32_t leftStartCount = leftWheel.getCount();
-  int32_t rightStartCount = rightWheel.getCount();
+  float dtSec = 0.0f;
+  if (mLastDriveTime != 0)
+  {
+    if (now - mLastDriveTime < SPEED_CONTROL_PERIOD_US)
+    {
+      return; // 制御周期未満は前回の出力を維持
+    }
+    dtSec = (now - mLastDriveTime) * 1.0e-6f;
+  }
+  mLastDriveTime = now;
+
+  if (mBatteryMv == 0)
+  {
+    mBatteryMv = hub_battery_get_voltage(); // 監視周期の前（走行前の校正など）
+  }
+  SensorSnapshot sensors = readSensors();
+  int leftPower = mLeftSpeedCtl.update(leftSpeed, sensors.leftSpeed, mBatteryMv, dtSec);
+  int rightPower = mRightSpeedCtl.update(rightSpeed, sensors.rightSpeed, mBatteryMv, dtSec);
+  mActuator.setPower(leftPower, rightPower);
+}
+
+/**
+ * 両輪を停止し、速度制御の内部状態をリセットする
+ * @param mode 停止方法
+ */
+void Tracer::stopWheels(StopMode mode)
+{
+  mActuator.stop(mode);
+  mLeftSpeedCtl.reset();
+  mRightSpeedCtl.reset();
+  mLastDriveTime = 0;
+}
+
+/**
+ * 直進する
+ * @param distanceCm 走行距離 (cm)
+ * @param stopMode 停止方法
+ */
+void Tracer::moveStraight(float distanceCm, StopMode stopMode)
+{
+  float degrees = DiffDrive::cmToDeg(distanceCm);
+  executeMotion(degrees, degrees, mCurrentBaseSpeed, stopMode);
+}
+
+/**
+ * 円弧走行する（外側車輪が基本速度）
+ * @param radiusCm 旋回半径 (cm、車体中心基準)
+ * @param angleDeg 旋回角度 (deg、正=左旋回、負=右旋回)
+ * @param stopMode 停止方法
+ */
+void Tracer::moveArc(float radiusCm, float angleDeg, StopMode stopMode)
+{
+  float leftDegrees;
+  float rightDegrees;
+  DiffDrive::arcToWheelDeg(radiusCm, angleDeg, leftDegrees, rightDegrees);
+  executeMotion(leftDegrees, rightDegrees, mCurrentBaseSpeed, stopMode);
+}
 
-  // 基本距離をエンコーダ角度に変換
-  float circumference = 3.14159265f * WHEEL_DIAMETER_CM;
-  float baseRotations = distanceCm / circumference;
-  int32_t baseDegrees = (int32_t)(baseRotations * 360.0f);
+/**
+ * 超信地旋回する
+ * @param angleDeg 旋回角度 (deg、正=左旋回、負=右旋回)
+ * @param stopMode 停止方法
+ */
+void Tracer::spinTurn(float angleDeg, StopMode stopMode)
+{
+  float leftDegrees;
+  float rightDegrees;
+  DiffDrive::spinToWheelDeg(angleDeg, leftDegrees, rightDegrees);
+  executeMotion(leftDegrees, rightDegrees, mCurrentBaseSpeed, stopMode);
+}
 
-  // 曲がり方向に応じて左右の目標距離を調整（turnIntensityで強度調整）
-  int32_t leftTargetDegrees = baseDegrees;
-  int32_t rightTargetDegrees = baseDegrees;
+/**
+ * 融合した向き（ジャイロ＋エンコーダ）が指定角度だけ変わるまで超信地旋回する
+ * スリップで車輪の回転角と実際の旋回角がずれても、向きで終了する。
+ * IMUのバイアス推定が済んでいない場合はspinTurn()と同じく回転角で判定する。
+ * @param angleDeg 旋回角度 (deg、正=左旋回、負=右旋回)
+ * @param stopMode 停止方法
+ */
+void Tracer::turnToAngle(float angleDeg, StopMode stopMode)
+{
+  float leftDegrees;
+  float rightDegrees;
+  DiffDrive::spinToWheelDeg(angleDeg, leftDegrees, rightDegrees);
+  executeMotion(leftDegrees, rightDegrees, mCurrentBaseSpeed, stopMode, true);
+}
 
-  if (direction == TurnDirection::LEFT)
+/**
+ * 左右の回転角を指定して走行する
+ * 回転角の大きい車輪を基準に速度プロファイルを作り、各車輪の速度は回転角に比例させる。
+ * 各車輪の進捗が全体の進捗率から計画した比率どおりになるよう、ずれに応じて
+ * 左右の速度を補正する（クロスカップリング）。
+ * IMUのバイアス推定済みなら、左右のずれの代わりにジャイロ＋エンコーダの向きと
+ * 計画の向きとのずれで補正する（ヘディングホールド、スリップも補正できる）。
+ * headingTerminationを指定した場合は、左右の進捗の代わりに融合した向きの変化で進捗と終了を判定する。
+ * 左右の進捗の合計が、目標の合計から停止時の行き過ぎ量の予測を引いた位置に達したら
+ * stopModeで停止し、計画に対する向きの誤差を表示する。ブレーキ・保持で止めた場合は止まるまで待って
+ * 行き過ぎ量を学習する（惰性はライントレース等への引き継ぎに使うので、待たずにすぐ戻る）。
+ * 時間・走行量の上限超過やストールで中断した場合と、同じ一連の動作の中で前の動作が
+ * 中断されていた場合（mMotionAborted）は、止まってfalseを返す。
+ * @param leftDeg 左車輪回転角 (deg、負=後退)
+ * @param rightDeg 右車輪回転角 (deg、負=後退)
+ * @param cruiseSpeed 基準車輪の巡航速度（パワー%換算）
+ * @param stopMode 停止方法
+ * @param headingTermination true=融合した向きが計画の向きに達したら終了（IMU未使用時は回転角で判定）
+ * @retval true 完了 / false 中断
+ */
+bool Tracer::executeMotion(float leftDeg, float rightDeg, int cruiseSpeed, StopMode stopMode, bool headingTermination)
+{
+  if (mMotionAborted)
   {
-    // 左曲がり：右ホイールをより多く回転（turnIntensityで調整）
-    float distanceMultiplier = 1.0f + (turnIntensity * 0.2f); // 基本+ turnIntensity×20%
-    rightTargetDegrees = (int32_t)(baseDegrees * distanceMultiplier);
-    printf("左曲がり - 距離倍率: %.2f, 右目標: %d度\n", distanceMultiplier, rightTargetDegrees);
+    printf("前の動作が中断されたため省略\n");
+    return false;
   }
-  else if (direction == TurnDirection::RIGHT)
+
+  float leftAbs = (leftDeg < 0.0f) ? -leftDeg : leftDeg;
+  float rightAbs = (rightDeg < 0.0f) ? -rightDeg : rightDeg;
+  float majorDeg = (leftAbs > rightAbs) ? leftAbs : rightAbs;
+  if (majorDeg < 1.0f)
   {
-    // 右曲がり：左ホイールをより多く回転（turnIntensityで調整）
-    float distanceMultiplier = 1.0f + (turnIntensity * 0.2f); // 基本+ turnIntensity×20%
-    leftTargetDegrees = (int32_t)(baseDegrees * distanceMultiplier);
-    printf("右曲がり - 距離倍率: %.2f, 左目標: %d度\n", distanceMultiplier, leftTargetDegrees);
+    return true; // 移動量なし
   }
+  float totalDeg = leftAbs + rightAbs;
+  float leftSign = (leftDeg < 0.0f) ? -1.0f : 1.0f;
+  float rightSign = (rightDeg < 0.0f) ? -1.0f : 1.0f;
 
-  int32_t leftTargetCount = leftStartCount + leftTargetDegrees;
-  int32_t rightTargetCount = rightStartCount + rightTargetDegrees;
+  // 開始時のエンコーダ値と向きを記録
+  int32_t leftStartCount = leftWheel.getCount();
+  int32_t rightStartCount = rightWheel.getCount();
+  updateOdometry();
+  float startHeading = mOdometry.getHeadingDeg();
+  float plannedHeading = DiffDrive::headingDeg(leftDeg, rightDeg);
+
+  // IMU使用可否と終了判定方法（向きで終了する場合、進捗は計画の向きに対する旋回の割合）
+  bool useImu = mImu.isCalibrated();
+  bool byHeading = headingTermination && useImu && (plannedHeading > 1.0f || plannedHeading < -1.0f);
+
+  mMoveProfile.start(majorDeg, WheelSpeedController::toDegPerSec(cruiseSpeed));
+  beginSupervision("走行", MotionSupervisor::timeBudgetUs(majorDeg, WheelSpeedController::toDegPerSec(cruiseSpeed)),
+                   majorDeg * MotionSupervisor::DISTANCE_MARGIN + MotionSupervisor::DISTANCE_SLACK_DEG);
+
+  // 計画方向への進捗（基準車輪の回転角に換算）
+  float turned = 0.0f;
+  float leftDone = 0.0f;
+  float rightDone = 0.0f;
+  auto updateProgress = [&]() {
+    updateOdometry();
+    turned = mOdometry.getHeadingDeg() - startHeading;
+    leftDone = (leftWheel.getCount() - leftStartCount) * leftSign;
+    rightDone = (rightWheel.getCount() - rightStartCount) * rightSign;
+    return byHeading ? (turned / plannedHeading * majorDeg)
+                     : ((leftDone + rightDone) / totalDeg * majorDeg);
+  };
+
+  // 停止指令を出した時点の進捗・速度と、その時の行き過ぎ量の予測
+  float stopProgress = 0.0f;
+  float stopSpeedDps = 0.0f;
+  float predictedOvershoot = 0.0f;
+
+  waitMotion("走行", [&]() {
+    if (!superviseMotion())
+    {
+      return true;
+    }
+    float progress = updateProgress();
+
+    // 予測した行き過ぎ量だけ手前で停止指令を出す
+    SensorSnapshot sensors = readSensors();
+    float progressSpeedDps = (abs(sensors.leftSpeed) + abs(sensors.rightSpeed)) / totalDeg * majorDeg;
+    float overshoot = mOvershoot.predict(stopMode, progressSpeedDps);
+    if (progress + overshoot >= majorDeg)
+    {
+      stopProgress = progress;
+      stopSpeedDps = progressSpeedDps;
+      predictedOvershoot = overshoot;
+      return true;
+    }
 
-  // turnIntensityに応じた速度差をつけて曲がる強度を調整
-  int leftPower = mCurrentBaseSpeed;
-  int rightPower = mCurrentBaseSpeed;
+    float ratio = progress / majorDeg;
+    float leftExcess;
+    float rightExcess;
+    if (useImu && !byHeading)
+    {
+      // 計画の向きとのずれを左右車輪の進みすぎ量に換算（正=進みすぎ）
+      float headingExcessLeft;
+      float headingExcessRight;
+      DiffDrive::spinToWheelDeg(turned - ratio * plannedHeading, headingExcessLeft, headingExcessRight);
+      leftExcess = headingExcessLeft * leftSign;
+      rightExcess = headingExcessRight * rightSign;
+    }
+    else
+    {
+      // 全体の進捗率から見た各車輪の計画進捗とのずれ（正=進みすぎ）
+      leftExcess = leftDone - ratio * leftAbs;
+      rightExcess = rightDone - ratio * rightAbs;
+    }
+    float leftCorrection = clampCorrection(SYNC_GAIN_PER_SEC * leftExcess);
+    float rightCorrection = clampCorrection(SYNC_GAIN_PER_SEC * rightExcess);
+
+    // プロファイル速度を回転角の比で左右に配分し、ずれの分だけ補正
+    float speedDps = mMoveProfile.speedAt(progress);
+    float leftDps = leftSign * (speedDps * leftAbs / majorDeg - leftCorrection);
+    float rightDps = rightSign * (speedDps * rightAbs / majorDeg - rightCorrection);
+    driveWheels((int)WheelSpeedController::fromDegPerSec(leftDps),
+                (int)WheelSpeedController::fromDegPerSec(rightDps));
+    return false;
+  }, WaitUntil::FOREVER, SPEED_CONTROL_PERIOD_US);
 
-  if (direction == TurnDirection::LEFT)
+  // 最終的に両方停止
+  stopWheels(stopMode);
+  if (mMotionAborted)
   {
-    // 左曲がり：左ホイールを遅くする（turnIntensityで調整）
-    float speedReduction = 0.1f + (turnIntensity * 0.1f); // 基本10%減速 + turnIntensity×10%
-    if (speedReduction > 0.8f) speedReduction = 0.8f;     // 最大80%減速まで
-    leftPower = (int)(mCurrentBaseSpeed * (1.0f - speedReduction));
-    if (leftPower < 5) leftPower = 5; // 最低速度保証
-    printf("左曲がり - 減速率: %.1f%%, 左速度: %d\n", speedReduction * 100, leftPower);
+    return false;
   }
-  else if (direction == TurnDirection::RIGHT)
+
+  // 止まりきってから行き過ぎ量を学習（止まりきらないうちに待ちが打ち切られた場合は学習しない）
+  // 惰性の動作は次の走行へ引き継ぐためのものなので、止まるのを待たない（惰性の予測は初期値のまま）
+  if (OVERSHOOT_LEARNING_ENABLED && stopMode != StopMode::COAST && waitForStabilization())
   {
-    // 右曲がり：右ホイールを遅くする（turnIntensityで調整）
-    float speedReduction = 0.1f + (turnIntensity * 0.1f); // 基本10%減速 + turnIntensity×10%
-    if (speedReduction > 0.8f) speedReduction = 0.8f;     // 最大80%減速まで
-    rightPower = (int)(mCurrentBaseSpeed * (1.0f - speedReduction));
-    if (rightPower < 5) rightPower = 5; // 最低速度保証
-    printf("右曲がり - 減速率: %.1f%%, 右速度: %d\n", speedReduction * 100, rightPower);
+    float finalProgress = updateProgress();
+    float overshoot = finalProgress - stopProgress;
+    mOvershoot.learn(stopMode, stopSpeedDps, overshoot);
+    printf("停止[%s] %.0fdeg/s - 行き過ぎ 予測: %.1fdeg, 実績: %.1fdeg, 目標との差: %.1fdeg\n",
+           WheelActuator::stopModeName(stopMode), stopSpeedDps, predictedOvershoot, overshoot,
+           finalProgress - majorDeg);
   }
 
-  // 前進開始（調整された速度差で）
-  leftWheel.setPower(leftPower);
-  rightWheel.setPower(rightPower);
+  // 計画に対する向きの誤差を表示（IMU使用時は融合した向き、未使用時はエンコーダの向き）
+  updateOdometry();
+  float actualHeading = mOdometry.getHeadingDeg() - startHeading;
+  float encoderHeading = DiffDrive::headingDeg(leftWheel.getCount() - leftStartCount,
+                                               rightWheel.getCount() - rightStartCount);
+  printf("走行完了 - 向き 計画: %.1f度, 実績: %.1f度 (エンコーダ: %.1f度), 誤差: %.1f度\n",
+         plannedHeading, actualHeading, encoderHeading, actualHeading - plannedHeading);
+  return true;
+}
 
-  // 平均距離で判定（スムーズな停止）
-  int32_t averageTarget = (leftTargetCount + rightTargetCount) / 2;
+/**
+ * 走行動作の監視を開始する
+ * @param name 動作名（中断時の表示に使う）
+ * @param timeBudgetUs 時間の上限 (us)
+ * @param distanceBudgetDeg 走行量の上限（回転角の大きい車輪, deg）
+ */
+void Tracer::beginSupervision(const char *name, uint32_t timeBudgetUs, float distanceBudgetDeg)
+{
+  SYSTIM now;
+  get_tim(&now);
+  mSupervisor.begin(name, now, timeBudgetUs, distanceBudgetDeg, leftWheel.getCount(), rightWheel.getCount());
+}
 
-  while (true)
+/**
+ * 走行動作を監視する（動作のループの中で毎回呼ぶ）
+ * @retval true 継続 / false 中断した（停止済み）
+ */
+bool Tracer::superviseMotion()
+{
+  SYSTIM now;
+  get_tim(&now);
+  MotionSupervisor::Cause cause = mSupervisor.check(now, leftWheel.getCount(), rightWheel.getCount(),
+                                                    mActuator.getLeftPower(), mActuator.getRightPower());
+  if (cause == MotionSupervisor::Cause::NONE)
   {
-    int32_t leftCurrentCount = leftWheel.getCount();
-    int32_t rightCurrentCount = rightWheel.getCount();
-    int32_t averageCurrent = (leftCurrentCount + rightCurrentCount) / 2;
+    return true;
+  }
+  abortMotion();
+  return false;
+}
+
+/**
+ * 走行動作を中断する
+ * 停止して原因を表示し、一連の動作の残りを飛ばすようにしてから通知する。
+ */
+void Tracer::abortMotion()
+{
+  stopWheels();
+  mSupervisor.report();
+  mMotionAborted = true;
+  mMotionAbortCount++;
+  notify(Event::MOTION_ABORTED);
+}
+
+/**
+ * 中断後の処理
+ * 中断がMAX_MOTION_ABORTS回に達したら完全停止し、そうでなければ呼び出し側でライン復帰から再開する。
+ */
+void Tracer::recoverFromAbort()
+{
+  if (mMotionAbortCount >= MAX_MOTION_ABORTS)
+  {
+    printf("動作中断が%d回に達したため完全停止します\n", mMotionAbortCount);
+    setCompleteStop(true);
+    return;
+  }
+  printf("残りの動作を中止し、ライン復帰から再開します（中断 %d回目）\n", mMotionAbortCount);
+}
+
+/**
+ * センシングタスクのスナップショット（エンコーダ値・ジャイロの積分角）でオドメトリを更新する
+ * 制御タスクから呼ばれ、ODOMETRY_PERIOD_US未満の呼び出しは何もしない
+ * （スナップショットはその周期でしか変わらない）。
+ */
+void Tracer::updateOdometry()
+{
+  SYSTIM now;
+  get_tim(&now);
 
-    // 平均距離で判定
-    if (averageCurrent >= averageTarget)
+  float dtSec = 0.0f;
+  if (mLastOdometryTime != 0)
+  {
+    if (now - mLastOdometryTime < ODOMETRY_PERIOD_US)
     {
-      break;
+      return;
     }
+    dtSec = (now - mLastOdometryTime) * 1.0e-6f;
   }
+  mLastOdometryTime = now;
 
-  // 最終的に両方停止
-  leftWheel.stop();
-  rightWheel.stop();
+  SensorSnapshot sensors = readSensors();
+  mOdometry.update(sensors.leftCount, sensors.rightCount, sensors.gyroHeadingDeg, sensors.gyroValid, dtSec);
+}
+
+/**
+ * 走行開始前に反射光の線形化テーブルを作る
+ * トレースするエッジ上に置いた状態から、その場旋回で左右にCAL_SWEEP_DEGずつゆっくり振り、
+ * エンコーダの向きから求めたセンサの横ずれと反射光を記録して中央に戻る。
+ * 失敗した場合は作成済みのテーブル（なければ従来どおり反射光 - target）をそのまま使う。
+ * 走行前の押下を受けてmain_taskから呼ぶ（センシングタスク開始後、arm()の前）。
+ * @return true=校正成功
+ */
+bool Tracer::calibrateReflection()
+{
+  int32_t leftStartCount = leftWheel.getCount();
+  int32_t rightStartCount = rightWheel.getCount();
+  const float sweepTargets[] = {CAL_SWEEP_DEG, -CAL_SWEEP_DEG, 0.0f};
+
+  mReflectionLinearizer.beginCalibration();
+  float heading = 0.0f;
+  for (float targetHeading : sweepTargets)
+  {
+    int direction = (targetHeading > heading) ? 1 : -1; // 1=左旋回
+    // 動けない場合はタイムアウトで打ち切る
+    WaitUntil::run(NULL, [&]() {
+      heading = DiffDrive::headingDeg(leftWheel.getCount() - leftStartCount,
+                                      rightWheel.getCount() - rightStartCount);
+      // 左旋回でセンサは線のある側へ動く（白地側が正）
+      float offsetCm = -getLineSideSign() * CAL_SENSOR_DISTANCE_CM * sinf(heading * 3.14159265f / 180.0f);
+      mReflectionLinearizer.addSample(readSensors().reflection, offsetCm);
+      if ((targetHeading - heading) * direction <= 0.0f)
+      {
+        return true;
+      }
+      driveWheels(-direction * CAL_SWEEP_SPEED, direction * CAL_SWEEP_SPEED);
+      return false;
+    }, CAL_TIMEOUT_US, CAL_SAMPLE_PERIOD_US);
+  }
+  stopWheels();
+
+  return mReflectionLinearizer.finishCalibration();
+}
+
+/**
+ * 走行開始前のジャイロバイアス推定（静止中に周期的に呼ぶ）
+ */
+void Tracer::calibrateImu()
+{
+  mImu.calibrate();
+}
+
+/**
+ * ハブIMUのヨー角速度を読み出す（ImuSamplerの読み出し関数）
+ * @return ヨー角速度 (deg/s、反時計回り正、バイアス未補正)
+ */
+float Tracer::readHubYawRate()
+{
+  static bool initialized = false;
+  if (!initialized)
+  {
+    hub_imu_init();
+    initialized = true;
+  }
+
+  float angularVelocity[3];
+  hub_imu_get_angular_velocity(angularVelocity);
+  return IMU_YAW_SIGN * angularVelocity[IMU_YAW_AXIS];
+}
+
+/**
+ * 左右同期の速度補正量を上限内に制限する
+ * @param correctionDps 補正量 (deg/s)
+ * @return 制限後の補正量 (deg/s)
+ */
+float Tracer::clampCorrection(float correctionDps)
+{
+  if (correctionDps > SYNC_MAX_CORRECTION_DPS) return SYNC_MAX_CORRECTION_DPS;
+  if (correctionDps < -SYNC_MAX_CORRECTION_DPS) return -SYNC_MAX_CORRECTION_DPS;
+  return correctionDps;
 }
 
 /**
@@ -330,60 +1321,79 @@ bool Tracer::isBlueDetectionEnabled() const
 
 /**
  * 青色検知時の動作実行（検知回数に応じた処理）
+ * 円弧の半径・角度は、低速モードで調整した旧方式（距離と曲がり強度）の左右回転角から換算した値。
+ * 半径がトレッド幅に近い急な円弧は、同じ到達姿勢になる超信地旋回と直進に置き換えている。
  */
 void Tracer::executeBlueAction()
 {
+  mMotionAborted = false;
+
   switch (mBlueDetectionCount)
   {
   case 1: // 1回目の青色検知
-    moveForward(20, TurnDirection::STRAIGHT, 0.0f);
-    //moveForward(13, TurnDirection::STRAIGHT, 0.0f);
-    // moveForward(10, TurnDirection::RIGHT, 1.3f);
-    moveForward(3, TurnDirection::RIGHT, 6.0f);
-    moveForward(14, TurnDirection::STRAIGHT, 0.0f);
+    moveStraight(20);
+    //moveStraight(13);
+    // moveArc(42.4f, -15.3f);
+    // 半径9.7cm・-28.1度の円弧と同じ位置・向きに、旋回→直進→旋回で移る
+    // （半径がトレッド幅の半分に近く、低速では内側車輪がほとんど回らずに止まりやすいため）
+    spinTurn(-14.05f);
+    moveStraight(4.7f);
+    spinTurn(-14.05f);
+    moveStraight(14, StopMode::COAST); // ライントレースへ引き継ぐ
     break;
 
   case 2: // 2回目の青色検知
-    moveForward(15, TurnDirection::RIGHT, 2.0f);
-    moveForward(12, TurnDirection::LEFT, 2.8f);
+    moveArc(31.7f, -32.5f);
+    moveArc(22.4f, 39.2f, StopMode::COAST); // ライントレースへ引き継ぐ
     printf("2回目の青色検知完了 - 完全停止します\n");
     break;
 
   case 3: // 3回目の青色検知
-    moveForward(8, TurnDirection::LEFT, 2.0f);
-    moveForward(9, TurnDirection::RIGHT, 2.2f);
+    moveArc(31.7f, 17.2f);
+    moveArc(28.0f, -22.3f, StopMode::COAST); // ライントレースへ引き継ぐ
     printf("3回目の青色検知完了 - 完全停止します\n");
     break;
 
   case 4: // 4回目の青色検知
-    moveForward(5, TurnDirection::RIGHT, 1.3f);
-    moveForward(2, TurnDirection::LEFT, 0.5f);
-    moveForward(5, TurnDirection::RIGHT, 1.3f);
+    moveArc(42.4f, -7.6f);
+    moveArc(61.6f, 1.9f);
+    moveArc(42.4f, -7.6f, StopMode::COAST); // 黒色検知まで続けて走る
     // 黒色検知まで直線走行
     printf("Case4: 黒色検知まで直線走行開始\n");
-    while (!detectBlack()) {
-      leftWheel.setPower(SLOW_BASE_SPEED);
-      rightWheel.setPower(SLOW_BASE_SPEED);
-    }
-    leftWheel.stop();
-    rightWheel.stop();
-    printf("Case4: 黒色を検知しました。直線走行終了\n");
+    beginSupervision("黒色検知", MOTION_TIMEOUT_US, DiffDrive::cmToDeg(BLACK_SEARCH_MAX_CM));
+    waitMotion("黒色検知", [this]() {
+      if (mMotionAborted || detectBlack() || !superviseMotion()) {
+        return true;
+      }
+      driveWheels(SLOW_BASE_SPEED, SLOW_BASE_SPEED);
+      return false;
+    }, WaitUntil::FOREVER, SPEED_CONTROL_PERIOD_US);
+    stopWheels();
+    printf("Case4: 直線走行終了\n");
     // 完全停止設定
     setCompleteStop(true);
     printf("4回目の青色検知完了 - 完全停止します\n");
     break;
   }
+
+  if (mMotionAborted && !mIsStopped)
+  {
+    recoverFromAbort();
+  }
 }
 
 /**
  * 動作安定化待機（モーター停止の完了を確実にする）
+ * 両輪の速度がSTABLE_SPEED_DPS以下になるまで待つ（STABILIZE_TIMEOUT_USで打ち切り）。
+ * @retval true 停止した / false 打ち切った
  */
-void Tracer::waitForStabilization()
+bool Tracer::waitForStabilization()
 {
-  // 短時間待機してモーターの完全停止を確実にする
-  for (volatile int i = 0; i < 50000; i++)
-    ;
-  printf("動作安定化待機完了\n");
+  WaitResult result = waitMotion("動作安定化", [this]() {
+    SensorSnapshot sensors = readSensors();
+    return abs(sensors.leftSpeed) <= STABLE_SPEED_DPS && abs(sensors.rightSpeed) <= STABLE_SPEED_DPS;
+  }, STABILIZE_TIMEOUT_US, STABILIZE_POLL_US);
+  return result.satisfied;
 }
 
 /**
@@ -415,20 +1425,43 @@ int Tracer::getCurrentBaseSpeed() const
 
 /**
  * 完全停止設定
+ * 記録・学習結果の出力は制御タスクでは行わず、通知を受けた側がfinish()で行う。
  * @param stopped true=完全停止, false=動作継続
  */
 void Tracer::setCompleteStop(bool stopped)
 {
   mIsStopped = stopped;
   if (stopped) {
-    leftWheel.stop();
-    rightWheel.stop();
+    stopWheels(FINISH_STOP_MODE);
     printf("完全停止モード有効\n");
+    notify(Event::STOPPED);
   } else {
     printf("動作継続モード\n");
   }
 }
 
+/**
+ * 状態変化の通知先を設定する
+ * 通知は制御タスクの中から呼ばれるので、通知先では待たずに済む処理（イベントフラグのセットなど）だけを行う。
+ * @param notifier 通知先（NULL=通知しない）
+ */
+void Tracer::setEventNotifier(EventNotifier notifier)
+{
+  mEventNotifier = notifier;
+}
+
+/**
+ * 状態変化を通知する
+ * @param event イベント
+ */
+void Tracer::notify(Event event)
+{
+  if (mEventNotifier != NULL)
+  {
+    mEventNotifier(event);
+  }
+}
+
 /**
  * 停止状態取得
  * @return true=停止中, false=動作中
@@ -438,12 +1471,68 @@ bool Tracer::isStopped() const
   return mIsStopped;
 }
 
+/**
+ * 直前のrun()で待ちを伴う動作（走行動作・エッジ切り替えなど）をしたか
+ * その回は実行時間に待ち時間が含まれるので、周期処理の統計とは分けて数える。
+ * @return true=待ちを伴う動作をした
+ */
+bool Tracer::wasBlocking() const
+{
+  return mBlockedInRun;
+}
+
+/**
+ * モーターへの書き込み回数を出力する
+ */
+void Tracer::printActuationStats() const
+{
+  mActuator.print();
+}
+
+/**
+ * 部品ごとのRAM使用量を出力する（静的に確保しているTracerの各メンバの大きさ）
+ * バッファの件数やビン数を変えた時に、スタックと合わせてRAMの割り当てを見直すのに使う。
+ */
+void Tracer::printMemoryUsage() const
+{
+  struct MemoryItem {
+    const char *name;
+    size_t bytes;
+  };
+  const MemoryItem items[] = {
+    {"モーター・カラーセンサ", sizeof(leftWheel) + sizeof(rightWheel) + sizeof(colorSensor)},
+    {"出力段", sizeof(mActuator)},
+    {"車輪速度制御", sizeof(mLeftSpeedCtl) + sizeof(mRightSpeedCtl)},
+    {"速度プロファイル", sizeof(mMoveProfile)},
+    {"IMU・オドメトリ", sizeof(mImu) + sizeof(mOdometry)},
+    {"コースマップ（記録）", sizeof(mRecordedMap)},
+    {"コースマップ（再生）", sizeof(mReplayMap)},
+    {"反復学習", sizeof(mLearning)},
+    {"ライン状態・横ずれ推定", sizeof(mLineStatus) + sizeof(mLineOffset)},
+    {"反射光の線形化", sizeof(mReflectionLinearizer)},
+    {"センサのスナップショット", sizeof(mSensorBuffer)},
+    {"レートスケジューラ", sizeof(mScheduler)},
+    {"走行ログ", sizeof(mTelemetry)},
+    {"動作の監視", sizeof(mSupervisor)},
+    {"行き過ぎ量の学習", sizeof(mOvershoot)},
+  };
+
+  size_t total = 0;
+  for (const MemoryItem &item : items)
+  {
+    printf("[ram] %s: %u byte\n", item.name, (unsigned)item.bytes);
+    total += item.bytes;
+  }
+  printf("[ram] その他の状態変数: %u byte\n", (unsigned)(sizeof(*this) - total));
+  printf("[ram] Tracer合計: %u byte\n", (unsigned)sizeof(*this));
+}
+
 /**
  * 初期処理実行
  * ①ライントレースを10秒間行う（追加）
  * ②前進を2秒ほどする
- * ③moveForward(2, TurnDirection::RIGHT, 5.0f);
- * ④moveForward(2, TurnDirection::LEFT, 5.0f);
+ * ③右カーブ（円弧）→直進
+ * ④左カーブ（円弧）
  * ⑤カラーセンサが黒を検知したら走行停止
  */
 void Tracer::performInitialSequence()
@@ -455,6 +1544,7 @@ void Tracer::performInitialSequence()
   if (firstRun) {
     printf("初期処理を開始します\n");
     mInitialStartTime = 0; // 簡易的な時間管理（実装依存）
+    mMotionAborted = false;
     sequenceStep = 0;
     stepStartTime = 0;
     firstRun = false;
@@ -476,20 +1566,13 @@ void Tracer::performInitialSequence()
       
       // 10秒間（100ms周期で100回＝10秒と仮定）
       if (timeCounter - stepStartTime >= 110) {
-        leftWheel.stop();
-        rightWheel.stop();
+        stopWheels();
         printf("ステップ0完了: 10秒間ライントレース終了\n");
         sequenceStep = 1;
         stepStartTime = 0; // 次のステップ用にリセット
       } else {
         // 通常のライントレース処理を実行
-        int diffReflection = calDiffReflection();
-        float turn = calcPropValue(diffReflection);
-        int adaptiveSpeed = calcAdaptiveSpeed(turn);
-        int pwm_l = adaptiveSpeed - turn;
-        int pwm_r = adaptiveSpeed + turn;
-        leftWheel.setPower(pwm_l);
-        rightWheel.setPower(pwm_r);
+        traceLine();
       }
       break;
 
@@ -503,14 +1586,12 @@ void Tracer::performInitialSequence()
       
       // 約2秒（100ms周期で20回＝2秒と仮定）
       if (timeCounter - stepStartTime >= 15) {
-        leftWheel.stop();
-        rightWheel.stop();
+        stopWheels();
         printf("ステップ1完了: 2秒間前進終了\n");
         sequenceStep = 2;
         stepStartTime = 0;
       } else {
-        leftWheel.setPower(mCurrentBaseSpeed);
-        rightWheel.setPower(mCurrentBaseSpeed);
+        driveWheels(mCurrentBaseSpeed, mCurrentBaseSpeed);
       }
       break;
 
@@ -520,8 +1601,8 @@ void Tracer::performInitialSequence()
       }
       
       if (timeCounter - stepStartTime >= 5) { // 500ms待機
-        printf("ステップ2: 右カーブ移動開始 (6cm, 強度3.0)\n");
-        moveForward(6, TurnDirection::RIGHT, 3.0f);
+        printf("ステップ2: 右カーブ移動開始 (半径22.4cm, 19.9度)\n");
+        moveArc(22.4f, -19.9f);
         printf("ステップ2完了: 右カーブ移動終了\n");
         sequenceStep = 3;
         stepStartTime = 0;
@@ -530,7 +1611,7 @@ void Tracer::performInitialSequence()
 
     case 3: // 直線走行20cm
       printf("ステップ3: 直線走行開始 (20cm)\n");
-      moveForward(15, TurnDirection::STRAIGHT, 0.0f);
+      moveStraight(15);
       printf("ステップ3完了: 直線走行終了\n");
       sequenceStep = 4;
       stepStartTime = 0;
@@ -542,8 +1623,8 @@ void Tracer::performInitialSequence()
       }
       
       if (timeCounter - stepStartTime >= 5) { // 500ms待機
-        printf("ステップ4: 左カーブ移動開始 (7cm, 強度3.0)\n");
-        moveForward(14, TurnDirection::LEFT, 1.8f);
+        printf("ステップ4: 左カーブ移動開始 (半径34.4cm, 27.5度)\n");
+        moveArc(34.4f, 27.5f, StopMode::COAST); // 黒色検知まで続けて走る
         printf("ステップ4完了: 左カーブ移動終了\n");
         sequenceStep = 5;
         stepStartTime = 0;
@@ -551,20 +1632,36 @@ void Tracer::performInitialSequence()
       break;
 
     case 5: // ⑤カラーセンサが黒を検知するまで待機
-      if (detectBlack()) {
-        leftWheel.stop();
-        rightWheel.stop();
-        printf("ステップ5完了: 黒色を検知しました。初期処理完了\n");
+      if (stepStartTime == 0) {
+        stepStartTime = timeCounter;
+        beginSupervision("初期処理 黒色検知", MOTION_TIMEOUT_US, DiffDrive::cmToDeg(BLACK_SEARCH_MAX_CM));
+      }
+      if (mMotionAborted || detectBlack() || !superviseMotion()) {
+        stopWheels();
+        if (mMotionAborted) {
+          printf("ステップ5中断: 黒色を検知できないまま初期処理を終了\n");
+        } else {
+          printf("ステップ5完了: 黒色を検知しました。初期処理完了\n");
+        }
         mInitialSequenceCompleted = true;
+        notify(Event::INITIAL_SEQUENCE_DONE);
         // 初期処理完了後、通常のライントレースと青色検知を有効にする
+        resetLineStatus();
         setLineTraceEnabled(true);
         setBlueDetectionEnabled(true);
+        // 中断した場合は線の上にいるとは限らないので、白地ならすぐに探索を始める
+        if (mMotionAborted) {
+          recoverFromAbort();
+          if (!mIsStopped && LineStatusEstimator::classify(calDiffReflection()) == LineStatusEstimator::State::ON_WHITE) {
+            startRecovery(false);
+          }
+        }
         sequenceStep = 0; // リセット
+        stepStartTime = 0; // リセット
         timeCounter = 0;  // リセット
         firstRun = true;  // リセット
       } else {
-        leftWheel.setPower(SLOW_BASE_SPEED);
-        rightWheel.setPower(SLOW_BASE_SPEED);
+        driveWheels(SLOW_BASE_SPEED, SLOW_BASE_SPEED);
       }
       break;
   }
@@ -575,7 +1672,7 @@ void Tracer::performInitialSequence()
  */
 bool Tracer::detectBlack() const
 {
-  int reflection = colorSensor.getReflection();
+  int reflection = readSensors().reflection;
   // 黒色の判定閾値（通常10以下が黒色）
   const int BLACK_THRESHOLD = 15;
   return reflection < BLACK_THRESHOLD;
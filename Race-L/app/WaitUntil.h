@@ -0,0 +1,63 @@
+#pragma once
+
+#include <stdint.h>
+#include <kernel.h>
+
+/**
+ * 待ち合わせの結果
+ */
+struct WaitResult {
+  bool satisfied;       // true=条件成立, false=タイムアウト
+  uint32_t elapsedUs;   // 待った時間 (us)
+  uint32_t polls;       // 条件を評価した回数
+};
+
+/**
+ * 条件が成立するまで待つ（dly_tskで周期的に条件を評価し、その間は他のタスクに譲る）
+ * 条件関数は評価のたびに呼ばれるので、待っている間の指令（モーター出力など）も条件関数の中で行う。
+ * 空回りのループと違い、待ち時間がコンパイラやCPU速度に依存せず、低優先度のタスクも動ける。
+ */
+class WaitUntil {
+public:
+  static const uint32_t FOREVER = 0;   // タイムアウトなし
+
+  /**
+   * 条件が成立するまで待つ
+   * @param name 表示名（結果の表示に使う、NULL=表示しない）
+   * @param condition 条件関数（bool()、trueで待ち終了）
+   * @param timeoutUs タイムアウト (us、FOREVER=なし)
+   * @param pollUs 条件を評価する周期 (us)
+   * @return 結果
+   */
+  template <typename Condition>
+  static WaitResult run(const char *name, Condition condition, uint32_t timeoutUs, uint32_t pollUs)
+  {
+    WaitResult result = {false, 0, 0};
+    SYSTIM start;
+    get_tim(&start);
+    while (true)
+    {
+      result.polls++;
+      if (condition())
+      {
+        result.satisfied = true;
+        break;
+      }
+      SYSTIM now;
+      get_tim(&now);
+      if (timeoutUs != FOREVER && now - start >= timeoutUs)
+      {
+        break;
+      }
+      dly_tsk(pollUs);
+    }
+    SYSTIM end;
+    get_tim(&end);
+    result.elapsedUs = (uint32_t)(end - start);
+    report(name, result);
+    return result;
+  }
+
+private:
+  static void report(const char *name, const WaitResult &result);  // 結果を表示
+};
@@ -0,0 +1,220 @@
+#include "WheelActuator.h"
+#include <stdio.h>
+
+/**
+ * コンストラクタ
+ * @param left 左車輪
+ * @param right 右車輪
+ */
+WheelActuator::WheelActuator(Motor &left, Motor &right) : mLeft(left),
+                                                          mRight(right),
+                                                          mLeftOutput(Output::UNKNOWN),
+                                                          mRightOutput(Output::UNKNOWN),
+                                                          mLeftPower(0),
+                                                          mRightPower(0)
+{
+  resetStats();
+}
+
+/**
+ * 左右のパワーを指令する
+ * 前回と同じ値の車輪は書き込まない。
+ * @param leftPower 左車輪のパワー (%)
+ * @param rightPower 右車輪のパワー (%)
+ */
+void WheelActuator::setPower(int leftPower, int rightPower)
+{
+  mCommandCount++;
+  bool writeLeft = (mLeftOutput != Output::POWER || mLeftPower != leftPower);
+  bool writeRight = (mRightOutput != Output::POWER || mRightPower != rightPower);
+
+  // 書き込みは続けて行い、間に計算を挟まない
+  HRTCNT leftTime = fch_hrt();
+  if (writeLeft)
+  {
+    mLeft.setPower(leftPower);
+  }
+  HRTCNT rightTime = fch_hrt();
+  if (writeRight)
+  {
+    mRight.setPower(rightPower);
+  }
+
+  if (writeLeft)
+  {
+    mLeftOutput = Output::POWER;
+    mLeftPower = leftPower;
+    mLeftWriteCount++;
+  }
+  if (writeRight)
+  {
+    mRightOutput = Output::POWER;
+    mRightPower = rightPower;
+    mRightWriteCount++;
+  }
+  if (writeLeft && writeRight)
+  {
+    recordSkew(leftTime, rightTime);
+  }
+}
+
+/**
+ * 両輪を指定の方法で止める（すでに同じ方法で止めている車輪は書き込まない）
+ * @param mode 停止方法
+ */
+void WheelActuator::stop(StopMode mode)
+{
+  mCommandCount++;
+  Output output = toOutput(mode);
+  bool writeLeft = (mLeftOutput != output);
+  bool writeRight = (mRightOutput != output);
+
+  HRTCNT leftTime = fch_hrt();
+  if (writeLeft)
+  {
+    applyStop(mLeft, mode);
+  }
+  HRTCNT rightTime = fch_hrt();
+  if (writeRight)
+  {
+    applyStop(mRight, mode);
+  }
+
+  if (writeLeft)
+  {
+    mLeftOutput = output;
+    mLeftPower = 0;
+    mLeftWriteCount++;
+  }
+  if (writeRight)
+  {
+    mRightOutput = output;
+    mRightPower = 0;
+    mRightWriteCount++;
+  }
+  if (writeLeft && writeRight)
+  {
+    recordSkew(leftTime, rightTime);
+  }
+}
+
+/**
+ * 前回値を忘れる
+ * モーターを直接操作した後など、実際の出力と前回値がずれた可能性がある場合に呼ぶ。
+ */
+void WheelActuator::invalidate()
+{
+  mLeftOutput = Output::UNKNOWN;
+  mRightOutput = Output::UNKNOWN;
+}
+
+/**
+ * 書き込み回数の集計をやり直す
+ */
+void WheelActuator::resetStats()
+{
+  mCommandCount = 0;
+  mLeftWriteCount = 0;
+  mRightWriteCount = 0;
+  mMaxSkewUs = 0;
+}
+
+/**
+ * 集計結果を出力する
+ */
+void WheelActuator::print() const
+{
+  uint32_t skipped = 2 * mCommandCount - mLeftWriteCount - mRightWriteCount;
+  printf("[motor] 指令 %lu回, 書き込み 左 %lu回 右 %lu回 (省略 %lu回), 左右の時間差 最大 %luus\n",
+         (unsigned long)mCommandCount, (unsigned long)mLeftWriteCount, (unsigned long)mRightWriteCount,
+         (unsigned long)skipped, (unsigned long)mMaxSkewUs);
+}
+
+/**
+ * 左車輪に出しているパワー取得
+ * @return パワー (%、出力なしは0)
+ */
+int WheelActuator::getLeftPower() const
+{
+  return mLeftPower;
+}
+
+/**
+ * 右車輪に出しているパワー取得
+ * @return パワー (%、出力なしは0)
+ */
+int WheelActuator::getRightPower() const
+{
+  return mRightPower;
+}
+
+/**
+ * 停止方法の表示名
+ * @param mode 停止方法
+ * @return 表示名
+ */
+const char *WheelActuator::stopModeName(StopMode mode)
+{
+  switch (mode)
+  {
+  case StopMode::BRAKE:
+    return "ブレーキ";
+  case StopMode::HOLD:
+    return "保持";
+  default:
+    return "惰性";
+  }
+}
+
+/**
+ * 停止方法に対応する出力の種類
+ * @param mode 停止方法
+ * @return 出力の種類
+ */
+WheelActuator::Output WheelActuator::toOutput(StopMode mode)
+{
+  switch (mode)
+  {
+  case StopMode::BRAKE:
+    return Output::BRAKE;
+  case StopMode::HOLD:
+    return Output::HOLD;
+  default:
+    return Output::COAST;
+  }
+}
+
+/**
+ * 1車輪を止める
+ * @param motor 車輪
+ * @param mode 停止方法
+ */
+void WheelActuator::applyStop(Motor &motor, StopMode mode)
+{
+  switch (mode)
+  {
+  case StopMode::BRAKE:
+    motor.brake();
+    break;
+  case StopMode::HOLD:
+    motor.hold();
+    break;
+  default:
+    motor.stop();
+    break;
+  }
+}
+
+/**
+ * 左右の書き込みの時間差を記録する
+ * @param leftTime 左車輪の書き込み開始時刻 (us)
+ * @param rightTime 右車輪の書き込み開始時刻 (us)
+ */
+void WheelActuator::recordSkew(HRTCNT leftTime, HRTCNT rightTime)
+{
+  uint32_t skew = (uint32_t)(rightTime - leftTime);
+  if (skew > mMaxSkewUs)
+  {
+    mMaxSkewUs = skew;
+  }
+}
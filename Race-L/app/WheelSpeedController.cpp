@@ -0,0 +1,82 @@
+#include "WheelSpeedController.h"
+
+// 速度制御用定数定義
+const float WheelSpeedController::DPS_PER_PERCENT = 10.0f;        // 100%で約1000deg/s（実機に合わせて調整）
+const float WheelSpeedController::NOMINAL_BATTERY_MV = 7800.0f;   // 調整時のバッテリ電圧
+const float WheelSpeedController::MIN_BATTERY_MV = 5000.0f;       // これ未満は測定異常として扱う
+const float WheelSpeedController::Kp = 0.02f;                     // 50deg/sの偏差で1%補正
+const float WheelSpeedController::Ki = 0.1f;                      // 積分ゲイン
+const float WheelSpeedController::INTEGRAL_LIMIT = 30.0f;         // 積分項の上限
+
+WheelSpeedController::WheelSpeedController() : mIntegral(0.0f)
+{
+}
+
+/**
+ * 内部状態をクリアする（停止時・動作切り替え時に呼ぶ）
+ */
+void WheelSpeedController::reset()
+{
+  mIntegral = 0.0f;
+}
+
+/**
+ * 指令速度を車輪角速度に換算する
+ * @param speed 指令速度（パワー%換算）
+ * @return 車輪角速度 (deg/s)
+ */
+float WheelSpeedController::toDegPerSec(float speed)
+{
+  return speed * DPS_PER_PERCENT;
+}
+
+/**
+ * 車輪角速度を指令速度に換算する
+ * @param dps 車輪角速度 (deg/s)
+ * @return 指令速度（パワー%換算）
+ */
+float WheelSpeedController::fromDegPerSec(float dps)
+{
+  return dps / DPS_PER_PERCENT;
+}
+
+/**
+ * 出力パワーを計算する
+ * @param targetSpeed 指令速度（パワー%換算）
+ * @param measuredDps エンコーダから得た現在の車輪角速度 (deg/s)
+ * @param batteryMv 現在のバッテリ電圧 (mV)
+ * @param dtSec 前回呼び出しからの経過時間 (s)、0なら積分しない
+ * @return モーターに与えるパワー (-100〜100)
+ */
+int WheelSpeedController::update(int targetSpeed, int32_t measuredDps, int batteryMv, float dtSec)
+{
+  // バッテリ電圧によるフィードフォワード（電圧が下がった分だけパワーを上乗せ）
+  float voltage = (batteryMv < MIN_BATTERY_MV) ? NOMINAL_BATTERY_MV : (float)batteryMv;
+  float feedForward = targetSpeed * (NOMINAL_BATTERY_MV / voltage);
+
+  // エンコーダ速度によるPI補正
+  float error = toDegPerSec(targetSpeed) - measuredDps;
+  float integral = mIntegral + Ki * error * dtSec;
+  if (integral > INTEGRAL_LIMIT) integral = INTEGRAL_LIMIT;
+  if (integral < -INTEGRAL_LIMIT) integral = -INTEGRAL_LIMIT;
+
+  float power = feedForward + Kp * error + integral;
+
+  // 出力飽和中は飽和方向への積分を止める（ワインドアップ防止）
+  if (power > MAX_POWER)
+  {
+    power = MAX_POWER;
+    if (error < 0) mIntegral = integral;
+  }
+  else if (power < -MAX_POWER)
+  {
+    power = -MAX_POWER;
+    if (error > 0) mIntegral = integral;
+  }
+  else
+  {
+    mIntegral = integral;
+  }
+
+  return (int)power;
+}
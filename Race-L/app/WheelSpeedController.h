@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * 車輪1輪分の速度制御器
+ * エンコーダ速度によるPI制御とバッテリ電圧によるフィードフォワード補償を行う。
+ * 指令速度は従来のsetPower()と同じ単位（公称電圧時のパワー%換算）で受け付けるため、
+ * 既存の速度定数をそのまま使える。
+ */
+class WheelSpeedController {
+public:
+  WheelSpeedController();
+  void reset();                          // 積分値などの内部状態をクリア
+  int update(int targetSpeed, int32_t measuredDps, int batteryMv, float dtSec); // 出力パワー計算
+
+  static float toDegPerSec(float speed);  // 指令速度[%] -> 車輪角速度[deg/s]
+  static float fromDegPerSec(float dps);  // 車輪角速度[deg/s] -> 指令速度[%]
+
+private:
+  // 制御定数
+  static const float DPS_PER_PERCENT;     // 指令1%あたりの車輪角速度 (deg/s)
+  static const float NOMINAL_BATTERY_MV;  // フィードフォワード基準電圧 (mV)
+  static const float MIN_BATTERY_MV;      // 電圧測定値の下限（異常値対策）
+  static const float Kp;                  // 速度偏差に対する比例ゲイン (%/(deg/s))
+  static const float Ki;                  // 速度偏差に対する積分ゲイン (%/deg)
+  static const float INTEGRAL_LIMIT;      // 積分項の上限 (%)
+  static const int MAX_POWER = 100;       // 出力パワーの上限
+
+  float mIntegral;                        // 積分項 (%)
+};
@@ -2,46 +2,174 @@
 #include <stdio.h>
 
 #include "Tracer.h"
+#include "TaskStats.h"
+#include "StackMonitor.h"
+#include "WaitUntil.h"
 #include "spike/pup/forcesensor.h"
 
 Tracer tracer;
+TaskStats sensorStats("sensor", SENSOR_PERIOD_US);
+TaskStats tracerStats("tracer", TRACER_PERIOD_US);
+static pup_device_t *force_sensor = NULL;
+
+STK_T main_task_stack[COUNT_STK_T(MAIN_STACK_SIZE)];
+STK_T tracer_task_stack[COUNT_STK_T(TRACER_STACK_SIZE)];
+STK_T sensor_task_stack[COUNT_STK_T(SENSOR_STACK_SIZE)];
+static HRTCNT pressTime = 0;        // フォースセンサー押下を検出した時刻 (us)
+static HRTCNT firstControlTime = 0; // 押下後に最初の制御を始めた時刻 (us)
 
 using namespace spikeapi;
 
+/*
+ * Tracerの状態変化をイベントフラグで通知する（制御タスクから呼ばれる）
+ */
+static void notifyTracerEvent(Tracer::Event event) {
+  switch (event) {
+  case Tracer::Event::INITIAL_SEQUENCE_DONE:
+    set_flg(TRACER_FLG, EVT_INITIAL_DONE);
+    break;
+  case Tracer::Event::PHASE_CHANGED:
+    set_flg(TRACER_FLG, EVT_PHASE_CHANGED);
+    break;
+  case Tracer::Event::STOPPED:
+    set_flg(TRACER_FLG, EVT_STOPPED);
+    break;
+  case Tracer::Event::MOTION_ABORTED:
+    set_flg(TRACER_FLG, EVT_MOTION_ABORTED);
+    break;
+  }
+}
+
+/*
+ * 各タスクのスタック領域を埋める（カーネル起動時、タスクの起動前に呼ばれる）
+ */
+void paint_stacks(intptr_t exinf) {
+  StackMonitor::paint(main_task_stack, ROUND_STK_T(MAIN_STACK_SIZE));
+  StackMonitor::paint(tracer_task_stack, ROUND_STK_T(TRACER_STACK_SIZE));
+  StackMonitor::paint(sensor_task_stack, ROUND_STK_T(SENSOR_STACK_SIZE));
+}
+
+/*
+ * スタックの最大使用量とRAM使用量を表示する
+ */
+static void print_memory_usage(void) {
+  StackMonitor::print("main", main_task_stack, ROUND_STK_T(MAIN_STACK_SIZE));
+  StackMonitor::print("tracer", tracer_task_stack, ROUND_STK_T(TRACER_STACK_SIZE));
+  StackMonitor::print("sensor", sensor_task_stack, ROUND_STK_T(SENSOR_STACK_SIZE));
+  tracer.printMemoryUsage();
+  printf("[ram] タスク統計: %u byte\n", (unsigned)(sizeof(sensorStats) + sizeof(tracerStats)));
+}
+
 void tracer_task(intptr_t exinf) {
+  HRTCNT start = fch_hrt();
+  if (firstControlTime == 0) {
+    firstControlTime = start;
+  }
+  tracerStats.begin(start);
   tracer.run();
+  // 走行動作などで待った回は、待ち時間を周期処理の実行時間に混ぜない
+  if (tracer.wasBlocking()) {
+    tracerStats.endBlocking(fch_hrt());
+  } else {
+    tracerStats.end(fch_hrt());
+  }
+  ext_tsk();
+}
+
+void sensor_task(intptr_t exinf) {
+  sensorStats.begin(fch_hrt());
+  tracer.sampleSensors();
+
+  // 走行準備の後、走行開始前はフォースセンサーの押下をここで（5ms周期で）検出し、静止中のジャイロバイアスを推定する
+  // 押下を検出したらすぐに制御の周期ハンドラを開始し、同じ周期のうちに最初のモーター指令を出す
+  // （反射光校正の旋回中はジャイロバイアスを推定せず、校正のための押下で走行を始めないようにする）
+  FLGPTN flags;
+  if (pol_flg(TRACER_FLG, EVT_ARMED | EVT_START, TWF_ORW, &flags) == E_OK
+      && (flags & EVT_ARMED) && !(flags & EVT_START)) {
+    tracer.calibrateImu();
+    if (pup_force_sensor_touched(force_sensor)) {
+      pressTime = fch_hrt();
+      sta_cyc(TRACER_CYC);
+      set_flg(TRACER_FLG, EVT_START);
+    }
+  }
+  sensorStats.end(fch_hrt());
   ext_tsk();
 }
 
 void main_task(intptr_t unused) {
+  FLGPTN flags;
+
+  force_sensor = pup_force_sensor_get_device(PBIO_PORT_ID_D);
+  tracer.setEventNotifier(notifyTracerEvent);
+
+  // センシングタスクを先に開始して、校正中のセンサ読み出しもスナップショット経由にする
+  sta_cyc(SENSOR_CYC);
+
+  // 1回目の押下: エッジ上に置いた状態でその場で左右に振り、反射光を校正する（離すまで待ってから動く）
+  printf("+-----------------------------------+\n");
+  printf("| Place on edge, press to calibrate |\n");
+  printf("+-----------------------------------+\n");
+  WaitUntil::run("校正の押下", []() { return pup_force_sensor_touched(force_sensor); },
+                 WaitUntil::FOREVER, PRESS_POLL_US);
+  WaitUntil::run(NULL, []() { return !pup_force_sensor_touched(force_sensor); },
+                 WaitUntil::FOREVER, PRESS_POLL_US);
+  if (!tracer.calibrateReflection()) {
+    printf("反射光の校正に失敗 - 校正前の対応（反射光 - 目標値）のまま走行します\n");
+  }
+
+  // 走行準備（エンコーダのリセットなど）を押下前に済ませてから、走行開始の押下を受け付ける
+  tracer.arm();
+  set_flg(TRACER_FLG, EVT_ARMED);
   printf("+---------------------------------+\n");
   printf("|   Press force sensor to start   |\n");
   printf("+---------------------------------+\n");
-  /* フォースセンサーが押下されるまで待機 */
-  pup_device_t *force_sensor = pup_force_sensor_get_device(PBIO_PORT_ID_D);
-  while (!pup_force_sensor_touched(force_sensor)) {
-    dly_tsk(10*1000);
-  }
+
+  /* フォースセンサーが押下されるまで待機（押下の検出と制御の開始はセンシングタスクが行う） */
+  wai_flg(TRACER_FLG, EVT_START, TWF_ORW, &flags);
   printf("Sample06: ETrobo_TR Style Line Trace with Initial Sequence\n");
   
-  // 初期処理付きでtracerを再初期化
-  tracer.init();
-  sta_cyc(TRACER_CYC);
-  
-  // 初期処理が未完了の場合のモニタリング
-  int monitorCount = 0;
-  while (!tracer.isInitialSequenceCompleted()) {
-    dly_tsk(150*1000); // 100msウェイト
-    if (monitorCount < 50) {
-      printf("初期処理実行中... (カウント: %d)\n", monitorCount);
-      monitorCount++;
-    }
-  }
+  // 初期処理の完了を待つ
+  printf("初期処理実行中...\n");
+  wai_flg(TRACER_FLG, EVT_INITIAL_DONE, TWF_ORW, &flags);
+  printf("初期処理完了 - ライントレース開始（押下から最初の制御まで %luus）\n",
+         (unsigned long)(firstControlTime - pressTime));
 
-  printf("初期処理完了 - ライントレース開始\n");
-
-  // ライントレースを無限に実行（終了条件なし）
+  // 区間の切り替え・動作の中断・完全停止を待ち、待っている間は走行ログを出力し、
+  // タスクごとの実行時間・周期ずれを定期的に表示（printfは制御タスクより低い優先度のこのタスクで行う）
+  int timeouts = 0;
   while (1) {
-    dly_tsk(100*1000); // 100msウェイト
+    ER ercd = twai_flg(TRACER_FLG, EVT_PHASE_CHANGED | EVT_MOTION_ABORTED | EVT_STOPPED, TWF_ORW, &flags, LOG_FLUSH_MS*1000);
+    tracer.flushTelemetry();
+    if (ercd == E_TMOUT) {
+      if (++timeouts >= STATS_PRINT_EVERY) {
+        timeouts = 0;
+        sensorStats.print();
+        tracerStats.print();
+        tracer.printActuationStats();
+      }
+      continue;
+    }
+    if (flags & EVT_PHASE_CHANGED) {
+      clr_flg(TRACER_FLG, ~EVT_PHASE_CHANGED);
+      printf("区間切り替え\n");
+    }
+    if (flags & EVT_MOTION_ABORTED) {
+      clr_flg(TRACER_FLG, ~EVT_MOTION_ABORTED);
+      printf("走行動作の中断を検知（原因は制御タスクの表示を参照）\n");
+    }
+    if (flags & EVT_STOPPED) {
+      // 周期ハンドラを止めて制御・センシングタスクが起動されないようにしてから、
+      // 最後のモーター指令と記録の出力をこのタスクで行う
+      stp_cyc(TRACER_CYC);
+      stp_cyc(SENSOR_CYC);
+      tracer.finish();
+      printf("走行終了\n");
+      sensorStats.print();
+      tracerStats.print();
+      tracer.printActuationStats();
+      print_memory_usage();
+      slp_tsk(); // 起床要求は出さないので、以降はどのタスクも動かない
+    }
   }
-}
\ No newline at end of file
+}
@@ -4,17 +4,54 @@ extern "C" {
 
 #include "spikeapi.h"
 
-#define MAIN_PRIORITY    (TMIN_APP_TPRI + 1)
-#define TRACER_PRIORITY  (TMIN_APP_TPRI + 2)
+#define SENSOR_PRIORITY  (TMIN_APP_TPRI)
+#define TRACER_PRIORITY  (TMIN_APP_TPRI + 1)
+#define MAIN_PRIORITY    (TMIN_APP_TPRI + 2)  /* イベント待ちと表示だけなので制御より低くする */
+
+#define SENSOR_PERIOD_US (5*1000)   /* センシングタスクの周期 */
+#define TRACER_PERIOD_US (50*1000)  /* 制御タスクの周期 */
+#define PRESS_POLL_US    (10*1000)  /* 走行前のフォースセンサー押下の確認周期（main_task） */
+#define LOG_FLUSH_MS     (1000)     /* 走行ログを出力する周期（main_task、1周期の記録件数がTELEMETRY_FLUSH_MAX以下になること） */
+#define STATS_PRINT_EVERY (5)       /* タスク統計を表示する間隔（LOG_FLUSH_MSの何回に1回か） */
+
+/* TRACER_FLGのビット */
+#define EVT_START          0x01  /* フォースセンサー押下（走行開始） */
+#define EVT_INITIAL_DONE   0x02  /* 初期処理完了 */
+#define EVT_PHASE_CHANGED  0x04  /* 青色検知による区間の切り替え */
+#define EVT_STOPPED        0x08  /* 完全停止 */
+#define EVT_MOTION_ABORTED 0x10  /* 走行動作の中断 */
+#define EVT_ARMED          0x20  /* 走行開始の押下を受け付ける（反射光校正と走行準備の後） */
 
 #ifndef STACK_SIZE
 #define STACK_SIZE      (4096)
 #endif /* STACK_SIZE */
 
+/* タスクごとのスタックサイズ（走行終了時の使用量の表示を見て詰める） */
+/* main_task: 走行前の反射光校正と走行後のfinish()（記録の出力）を行う。校正の作業領域は
+   ReflectionLinearizerのメンバーに置いてあり、アプリの関数のフレームは最も深い経路でも0.5KB未満
+   （ホストの-fstack-usageで確認）。残りはprintf（%f）の分なので、走行終了時の[stack] mainの
+   実測値に1KB程度の余裕を足した値まで詰める */
+#ifndef MAIN_STACK_SIZE
+#define MAIN_STACK_SIZE   (4096)
+#endif /* MAIN_STACK_SIZE */
+#ifndef TRACER_STACK_SIZE
+#define TRACER_STACK_SIZE STACK_SIZE
+#endif /* TRACER_STACK_SIZE */
+#ifndef SENSOR_STACK_SIZE
+#define SENSOR_STACK_SIZE STACK_SIZE
+#endif /* SENSOR_STACK_SIZE */
+
 #ifndef TOPPERS_MACRO_ONLY
 
 extern void main_task(intptr_t exinf);
 extern void tracer_task(intptr_t exinf);
+extern void sensor_task(intptr_t exinf);
+extern void paint_stacks(intptr_t exinf);
+
+/* 使用量を測るためにアプリケーションで確保するスタック領域 */
+extern STK_T main_task_stack[];
+extern STK_T tracer_task_stack[];
+extern STK_T sensor_task_stack[];
 
 #endif /* TOPPERS_MACRO_ONLY */
 
@@ -0,0 +1,153 @@
+#include "CourseMap.h"
+#include <stdio.h>
+#include <math.h>
+
+// コースマップ用定数定義
+const float CourseMap::BIN_CM = 5.0f;              // 5cmごとに記録（20mで400区間）
+const float CourseMap::CURVATURE_SCALE = 10000.0f; // 半径10cmで1000
+
+CourseMap::CourseMap() : mCount(0),
+                         mBinStartHeading(0.0f),
+                         mLastDistanceCm(0.0f),
+                         mLastHeadingDeg(0.0f)
+{
+}
+
+/**
+ * 記録を消去する
+ */
+void CourseMap::clear()
+{
+  mCount = 0;
+  mBinStartHeading = 0.0f;
+  mLastDistanceCm = 0.0f;
+  mLastHeadingDeg = 0.0f;
+}
+
+/**
+ * 保存済みデータを読み込む
+ * @param data 区間ごとの保存値
+ * @param count 区間数（MAX_BINSを超える分は捨てる）
+ */
+void CourseMap::load(const int16_t *data, int count)
+{
+  if (count > MAX_BINS) count = MAX_BINS;
+  for (int i = 0; i < count; i++)
+  {
+    mBins[i] = data[i];
+  }
+  mCount = count;
+}
+
+/**
+ * 走行距離と向きを取り込み、区間の終わりに達したらその区間の曲率を記録する
+ * 後退やその場旋回で距離が進まない間は記録しない。
+ * 1回の呼び出しで複数の区間の終わりを越えた場合は、前回からの向きの変化を
+ * 距離に比例して各区間の終わりに割り振る（前回と今回の間を線形補間）。
+ * @param distanceCm オドメトリの累積走行距離 (cm)
+ * @param headingDeg オドメトリの向き (deg)
+ */
+void CourseMap::record(float distanceCm, float headingDeg)
+{
+  float stepCm = distanceCm - mLastDistanceCm;
+  while (mCount < MAX_BINS && distanceCm >= (mCount + 1) * BIN_CM)
+  {
+    float binEndCm = (mCount + 1) * BIN_CM;
+    float binEndHeading = headingDeg;
+    if (stepCm > 0.0f && binEndCm > mLastDistanceCm)
+    {
+      binEndHeading = mLastHeadingDeg + (headingDeg - mLastHeadingDeg) * (binEndCm - mLastDistanceCm) / stepCm;
+    }
+    float curvature = (binEndHeading - mBinStartHeading) * 3.14159265f / 180.0f / BIN_CM;
+    float scaled = curvature * CURVATURE_SCALE;
+    if (scaled > 32767.0f) scaled = 32767.0f;
+    if (scaled < -32767.0f) scaled = -32767.0f;
+    mBins[mCount++] = (int16_t)scaled;
+    mBinStartHeading = binEndHeading;
+  }
+  mLastDistanceCm = distanceCm;
+  mLastHeadingDeg = headingDeg;
+}
+
+/**
+ * 記録済み区間数取得
+ * @return 区間数
+ */
+int CourseMap::getBinCount() const
+{
+  return mCount;
+}
+
+/**
+ * 区間の保存値取得
+ * @param index 区間番号
+ * @return 曲率の保存値（範囲外は0）
+ */
+int16_t CourseMap::getBin(int index) const
+{
+  if (index < 0 || index >= mCount)
+  {
+    return 0;
+  }
+  return mBins[index];
+}
+
+/**
+ * 指定距離の曲率を取得する
+ * @param distanceCm 走行距離 (cm)
+ * @return 曲率 (1/cm、正=左カーブ、記録範囲外は0)
+ */
+float CourseMap::curvatureAt(float distanceCm) const
+{
+  return getBin((int)(distanceCm / BIN_CM)) / CURVATURE_SCALE;
+}
+
+/**
+ * 先読み範囲内の曲率から現在地点の上限速度を求める
+ * 各区間の横加速度制限速度から、減速度で間に合う速度を逆算した最小値を返す。
+ * @param distanceCm 現在の走行距離 (cm)
+ * @param maxSpeedCms 直線での最高速度 (cm/s)
+ * @param latAccelCms2 許容横加速度 (cm/s^2)
+ * @param decelCms2 減速度 (cm/s^2)
+ * @param lookaheadCm 先読み距離 (cm)
+ * @return 上限速度 (cm/s)
+ */
+float CourseMap::speedLimitAt(float distanceCm, float maxSpeedCms, float latAccelCms2, float decelCms2, float lookaheadCm) const
+{
+  float limit2 = maxSpeedCms * maxSpeedCms;
+  int first = (int)(distanceCm / BIN_CM);
+  int last = (int)((distanceCm + lookaheadCm) / BIN_CM);
+  if (first < 0) first = 0;
+  if (last >= mCount) last = mCount - 1;
+
+  for (int i = first; i <= last; i++)
+  {
+    float curvature = fabsf(mBins[i] / CURVATURE_SCALE);
+    if (curvature < 1.0e-4f)
+    {
+      continue; // ほぼ直線
+    }
+    float ahead = i * BIN_CM - distanceCm;
+    if (ahead < 0.0f) ahead = 0.0f;
+    // v^2 = a_lat / kappa の速度まで、残り距離で減速できる上限
+    float allowed2 = latAccelCms2 / curvature + 2.0f * decelCms2 * ahead;
+    if (allowed2 < limit2) limit2 = allowed2;
+  }
+  return sqrtf(limit2);
+}
+
+/**
+ * 記録内容をCourseMapData.hの形式で出力する（ログから貼り付けて再走行に使う）
+ */
+void CourseMap::dump() const
+{
+  printf("// ---- CourseMapData.h ----\n");
+  printf("static const int COURSE_MAP_BIN_COUNT = %d;\n", mCount);
+  printf("static const int16_t COURSE_MAP_DATA[] = {\n");
+  for (int i = 0; i < mCount; i++)
+  {
+    printf("%d,%s", mBins[i], (i % 16 == 15) ? "\n" : " ");
+  }
+  printf("0\n};\n");
+  printf("// ---- end ----\n");
+}
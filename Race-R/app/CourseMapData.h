@@ -0,0 +1,10 @@
+#pragma once
+
+#include <stdint.h>
+
+// 偵察走行で記録したコースマップ（走行終了時のCourseMap::dump()出力を貼り付ける）
+// COURSE_MAP_BIN_COUNTが0の間は再走行時の速度計画を行わない
+static const int COURSE_MAP_BIN_COUNT = 0;
+static const int16_t COURSE_MAP_DATA[] = {
+0
+};
@@ -0,0 +1,18 @@
+#pragma once
+
+/**
+ * 差動二輪の運動学
+ * 円弧（半径・角度）や超信地旋回（角度）を左右車輪の回転角に換算する。
+ * 角度は反時計回り（左旋回）を正とする。
+ */
+class DiffDrive {
+public:
+  static const float WHEEL_DIAMETER_CM;  // ホイール直径 (cm)
+  static const float TRACK_WIDTH_CM;     // 左右車輪の接地点間隔 (cm)
+
+  static float cmToDeg(float cm);        // 走行距離 -> 車輪回転角
+  static float degToCm(float deg);       // 車輪回転角 -> 走行距離
+  static void arcToWheelDeg(float radiusCm, float angleDeg, float &leftDeg, float &rightDeg); // 円弧 -> 左右回転角
+  static void spinToWheelDeg(float angleDeg, float &leftDeg, float &rightDeg);                // 超信地旋回 -> 左右回転角
+  static float headingDeg(float leftDeg, float rightDeg);                                      // 左右回転角 -> 向きの変化
+};
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "GainSchedule.h"
+
+// コースごとのゲインスケジュール（区間は開始距離の昇順、速度は昇順）
+// 速度の範囲外は端の値を使う。区間を追加する場合は走行ログの距離を目安に区切る
+// 速度は旋回量で減速する前の計画速度で選ぶ。実機で調整済みなのはKp=0.8, Kd=0.2だけなので、
+// 走行ログで速度ごとの値を確かめるまではどの速度も同じ値にしておく
+static constexpr GainScheduleSegment GAIN_SCHEDULE[] = {
+  // 開始距離  {速度, {Kp, Kd, バイアス}} × 3
+  {0.0f, {{30, {0.8f, 0.2f, 0.0f}},     // 青色検知後の低速
+          {50, {0.8f, 0.2f, 0.0f}},     // 通常速度
+          {70, {0.8f, 0.2f, 0.0f}}}},   // 記録済みコースの直線
+};
+static constexpr int GAIN_SCHEDULE_SEGMENT_COUNT = sizeof(GAIN_SCHEDULE) / sizeof(GAIN_SCHEDULE[0]);
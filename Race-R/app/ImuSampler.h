@@ -0,0 +1,26 @@
+#pragma once
+
+/**
+ * IMUのヨー角速度サンプリング
+ * 起動時（静止中）にジャイロのバイアスを推定し、補正済みのヨー角速度を返す。
+ * センサの読み出しは関数ポインタで注入するため、ホスト上でも模擬データで動作する。
+ */
+class ImuSampler {
+public:
+  typedef float (*YawRateReader)();         // 生のヨー角速度 (deg/s、反時計回り正) を返す関数
+
+  explicit ImuSampler(YawRateReader reader);
+  void calibrate();                         // 静止中に呼び、バイアスを推定する
+  bool isCalibrated() const;                // バイアス推定完了状態取得
+  float sample();                           // バイアス補正済みヨー角速度 (deg/s)
+  float getBias() const;                    // 推定バイアス取得 (deg/s)
+
+private:
+  static const int BIAS_SAMPLES = 200;      // バイアス推定に必要なサンプル数
+  static const float BIAS_TRACK_RATE;       // 推定完了後の追従率（温度ドリフト対策）
+  static const float STILL_THRESHOLD_DPS;   // 静止とみなす角速度の上限 (deg/s)
+
+  YawRateReader mReader;                    // センサ読み出し関数
+  float mBias;                              // 推定バイアス (deg/s)
+  int mBiasCount;                           // バイアス推定に使ったサンプル数
+};
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <stdint.h>
+
+// 前回までの走行で学習した操舵補正（走行終了時のIterativeLearning::dump()出力を貼り付ける）
+// LEARNING_BIN_COUNTが0の間は補正なし（学習は今回の走行から始まる）
+static const int LEARNING_LAP = 0;
+static const int LEARNING_BIN_COUNT = 0;
+static const int8_t LEARNING_CORRECTION_DATA[] = {
+0
+};
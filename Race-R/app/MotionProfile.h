@@ -0,0 +1,24 @@
+#pragma once
+
+/**
+ * 台形速度プロファイル（距離領域）
+ * 走行済み距離から指令速度を求める。加速・巡航・減速の3区間からなり、
+ * 減速は予測停止距離（制動距離＋応答遅れ中の空走距離）が残り距離に達した時点で開始する。
+ * 距離・速度の単位は呼び出し側で揃える（Tracerではdeg, deg/s）。
+ */
+class MotionProfile {
+public:
+  MotionProfile(float accel, float decel, float minSpeed, float latencySec);
+  void start(float distance, float cruiseSpeed); // プロファイル開始
+  float speedAt(float traveled) const;            // 走行済み距離に対する指令速度
+  float stoppingDistance(float speed) const;      // 指定速度からの予測停止距離
+  float getDistance() const;                      // 目標距離取得
+
+private:
+  float mAccel;        // 加速度
+  float mDecel;        // 減速度
+  float mMinSpeed;     // 最低速度（発進・停止直前に車輪が止まらない速度）
+  float mLatencySec;   // 指令から減速が効き始めるまでの遅れ (s)
+  float mDistance;     // 目標距離
+  float mCruiseSpeed;  // 巡航速度
+};
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <stdint.h>
+#include <kernel.h>
+
+/**
+ * 走行動作の監視
+ * 動作ごとに時間と走行量の上限を決め、上限を超えた場合と、パワーをかけているのに
+ * 車輪が回らない状態（ストール）が続いた場合に中断を判定する。
+ * 判定だけを行い、停止・復帰などの処理は呼び出し側（Tracer）が行う。
+ */
+class MotionSupervisor {
+public:
+  // 中断の原因
+  enum class Cause {
+    NONE,           // 中断なし
+    TIMEOUT,        // 時間の上限を超えた
+    OVER_DISTANCE,  // 走行量の上限を超えた
+    STALL           // パワーをかけても車輪が回らない
+  };
+
+  MotionSupervisor();
+  void begin(const char *name, SYSTIM now, uint32_t timeBudgetUs, float distanceBudgetDeg,
+             int32_t leftCount, int32_t rightCount);          // 動作の監視開始
+  Cause check(SYSTIM now, int32_t leftCount, int32_t rightCount,
+              int leftPower, int rightPower);                 // 1周期分の判定
+  void report() const;                                        // 中断の原因を表示
+  Cause getCause() const;                                     // 中断の原因取得
+  const char *getName() const;                                // 監視中の動作名取得
+  static const char *causeName(Cause cause);                  // 原因の表示名
+  static uint32_t timeBudgetUs(float distanceDeg, float cruiseDps); // 走行量と巡航速度から時間の上限を求める
+
+  static const float DISTANCE_MARGIN;        // 計画の走行量に対する上限の倍率
+  static const float DISTANCE_SLACK_DEG;     // 走行量の上限に足す余裕 (deg)
+
+private:
+  // 車輪ごとのストール判定区間（パワーをかけ始めた時点・最後に回った時点から見る）
+  struct WheelWatch {
+    int32_t count;    // 判定区間の開始時のエンコーダ値 (deg)
+    SYSTIM since;     // 判定区間の開始時刻 (us)
+  };
+  static bool isStalled(WheelWatch &watch, SYSTIM now, int32_t count, int power); // ストール判定
+
+  static const float TIME_MARGIN;            // 計画の所要時間に対する上限の倍率
+  static const uint32_t TIME_SLACK_US;       // 時間の上限に足す余裕 (us)
+  static const float MIN_CRUISE_DPS;         // 所要時間の計算に使う速度の下限 (deg/s)
+  static const int STALL_MIN_POWER;          // ストールとみなすパワーの下限 (%)
+  static const int32_t STALL_MIN_DEG;        // この角度回ればストールでない (deg)
+  static const uint32_t STALL_TIME_US;       // ストールとみなす継続時間 (us)
+
+  const char *mName;          // 動作名
+  SYSTIM mStartTime;          // 開始時刻 (us)
+  uint32_t mTimeBudgetUs;     // 時間の上限 (us)
+  float mDistanceBudgetDeg;   // 走行量の上限（回転角の大きい車輪, deg）
+  int32_t mLeftStartCount;    // 開始時の左エンコーダ値
+  int32_t mRightStartCount;   // 開始時の右エンコーダ値
+  WheelWatch mLeftWatch;      // 左車輪のストール判定
+  WheelWatch mRightWatch;     // 右車輪のストール判定
+  Cause mCause;               // 中断の原因
+  uint32_t mElapsedUs;        // 中断時の経過時間 (us)
+  float mTraveledDeg;         // 中断時の走行量 (deg)
+};
@@ -0,0 +1,18 @@
+#pragma once
+
+/**
+ * 予測操舵（陽的MPC）
+ * 横ずれ・向きずれ・ヨーレートと、予測区間分の線の曲率から、次の周期のヨーレート指令を求める。
+ * 最適化はmpc_gain_gen（tools/）で速度ごとに事前に解いてMpcGainTable.hに置いてあり、
+ * 実行時は速度で2点間を補間して内積を取るだけ（1周期の計算量は予測区間に比例して一定）。
+ * 横ずれ・向きずれ・ヨーレート・曲率はすべて「白地側が正」の線基準の向きで渡す。
+ */
+class MpcSteering {
+public:
+  static const int MAX_HORIZON = 16; // 呼び出し側で用意する曲率配列の大きさ
+  static const int HORIZON;   // 予測区間（周期数、MAX_HORIZON以下）
+  static const float DT_SEC;  // 予測の1周期 (s)
+
+  static float compute(float offsetCm, float headingRad, float yawRate, float speedCms,
+                       const float *curvature, float maxYawRate); // ヨーレート指令 (rad/s、線のある側へ曲がる向きが正)
+};
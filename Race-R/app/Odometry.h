@@ -0,0 +1,32 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * オドメトリ（自己位置推定）
+ * エンコーダから求めた向き（低域）と、センシングタスクで積分したジャイロの角度（高域）を
+ * 相補フィルタで融合して向きを求め、その向きで走行距離を積分して位置を求める。
+ */
+class Odometry {
+public:
+  Odometry();
+  void reset(int32_t leftCount, int32_t rightCount);  // 現在のエンコーダ値を原点にする
+  void update(int32_t leftCount, int32_t rightCount, float gyroHeadingDeg, bool gyroValid, float dtSec); // 推定更新
+  float getHeadingDeg() const;     // 向き (deg、反時計回り正)
+  float getDistanceCm() const;     // 累積走行距離 (cm、後退は減算)
+  float getXCm() const;            // 位置X (cm、開始時の前方)
+  float getYCm() const;            // 位置Y (cm、開始時の左方)
+
+private:
+  static const float FUSION_TIME_CONSTANT_SEC; // 相補フィルタの時定数（これより速い変化はジャイロ、遅い変化はエンコーダ）
+
+  int32_t mLastLeftCount;          // 前回の左エンコーダ値
+  int32_t mLastRightCount;         // 前回の右エンコーダ値
+  float mLastGyroHeadingDeg;       // 前回のジャイロ積分角
+  bool mHasGyroReference;          // mLastGyroHeadingDegが有効か
+  float mEncoderHeadingDeg;        // エンコーダだけで求めた向き
+  float mHeadingDeg;               // 向き（融合後）
+  float mDistanceCm;               // 累積走行距離
+  float mXCm;                      // 位置X
+  float mYCm;                      // 位置Y
+};
@@ -0,0 +1,114 @@
+#include "OvershootModel.h"
+#include <stdio.h>
+
+const float OvershootModel::SPEED_BIN_DPS = 100.0f;  // 0～800deg/sを8区間
+// 惰性は摩擦だけで止まるので長く、保持は位置制御で引き戻すので短い
+const float OvershootModel::PRIOR_STOP_SEC[MODE_COUNT] = {0.08f, 0.03f, 0.02f};
+const float OvershootModel::LEARNING_RATE = 0.3f;       // 数回の停止で追従する
+const float OvershootModel::MAX_OVERSHOOT_DEG = 180.0f; // 外れ値で早く止まりすぎないように
+
+OvershootModel::OvershootModel()
+{
+  static_assert((int)StopMode::HOLD + 1 == MODE_COUNT, "StopModeとMODE_COUNTの数が違う");
+  reset();
+}
+
+/**
+ * 学習結果を初期値（速度×停止時間の目安）に戻す
+ */
+void OvershootModel::reset()
+{
+  for (int mode = 0; mode < MODE_COUNT; mode++)
+  {
+    for (int bin = 0; bin < SPEED_BIN_COUNT; bin++)
+    {
+      float centerDps = (bin + 0.5f) * SPEED_BIN_DPS;
+      mOvershootDeg[mode][bin] = centerDps * PRIOR_STOP_SEC[mode];
+      mSamples[mode][bin] = 0;
+    }
+  }
+}
+
+/**
+ * 行き過ぎ量を予測する（区間の中央の値を線形補間）
+ * @param mode 停止方法
+ * @param speedDps 停止指令を出す時の速度 (deg/s)
+ * @return 行き過ぎ量 (deg)
+ */
+float OvershootModel::predict(StopMode mode, float speedDps) const
+{
+  if (speedDps < 0.0f) speedDps = -speedDps;
+  const float *table = mOvershootDeg[(int)mode];
+
+  float position = speedDps / SPEED_BIN_DPS - 0.5f;
+  if (position <= 0.0f)
+  {
+    // 最初の区間の中央より遅い場合は0に向かって比例させる
+    float centerDps = 0.5f * SPEED_BIN_DPS;
+    return table[0] * speedDps / centerDps;
+  }
+  int lower = (int)position;
+  if (lower >= SPEED_BIN_COUNT - 1)
+  {
+    return table[SPEED_BIN_COUNT - 1];
+  }
+  float t = position - lower;
+  return table[lower] + (table[lower + 1] - table[lower]) * t;
+}
+
+/**
+ * 実績を学習する
+ * @param mode 停止方法
+ * @param speedDps 停止指令を出した時の速度 (deg/s)
+ * @param overshootDeg 停止指令から止まるまでに進んだ回転角 (deg)
+ */
+void OvershootModel::learn(StopMode mode, float speedDps, float overshootDeg)
+{
+  if (overshootDeg < 0.0f) overshootDeg = 0.0f;
+  if (overshootDeg > MAX_OVERSHOOT_DEG) overshootDeg = MAX_OVERSHOOT_DEG;
+
+  // 区間の中央の速度に換算してから平滑化する（速度に比例するとみなす）
+  int bin = speedBin(speedDps);
+  if (speedDps < 0.0f) speedDps = -speedDps;
+  float centerDps = (bin + 0.5f) * SPEED_BIN_DPS;
+  float scaled = (speedDps > 1.0f) ? overshootDeg * centerDps / speedDps : overshootDeg;
+  if (scaled > MAX_OVERSHOOT_DEG) scaled = MAX_OVERSHOOT_DEG;
+
+  float &value = mOvershootDeg[(int)mode][bin];
+  value += LEARNING_RATE * (scaled - value);
+  if (mSamples[(int)mode][bin] < 255)
+  {
+    mSamples[(int)mode][bin]++;
+  }
+}
+
+/**
+ * 学習結果を出力する（学習した区間だけ）
+ */
+void OvershootModel::print() const
+{
+  for (int mode = 0; mode < MODE_COUNT; mode++)
+  {
+    for (int bin = 0; bin < SPEED_BIN_COUNT; bin++)
+    {
+      if (mSamples[mode][bin] == 0)
+      {
+        continue;
+      }
+      printf("[overshoot] %s %4.0fdeg/s: %.1fdeg (%u回)\n", WheelActuator::stopModeName((StopMode)mode),
+             (bin + 0.5f) * SPEED_BIN_DPS, mOvershootDeg[mode][bin], (unsigned)mSamples[mode][bin]);
+    }
+  }
+}
+
+/**
+ * 速度を区間番号に変換する
+ * @param speedDps 速度 (deg/s)
+ * @return 区間番号
+ */
+int OvershootModel::speedBin(float speedDps)
+{
+  if (speedDps < 0.0f) speedDps = -speedDps;
+  int bin = (int)(speedDps / SPEED_BIN_DPS);
+  return (bin >= SPEED_BIN_COUNT) ? SPEED_BIN_COUNT - 1 : bin;
+}
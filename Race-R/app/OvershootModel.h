@@ -0,0 +1,33 @@
+#pragma once
+
+#include <stdint.h>
+#include "WheelActuator.h"
+
+/**
+ * 停止時の行き過ぎ量の学習
+ * 停止指令を出した時の速度と、止まるまでに進んだ回転角の関係を停止方法ごと・速度の区間ごとに
+ * 指数平滑で学習する。走行動作はこの予測値だけ手前で停止指令を出すことで、速度によらず
+ * 目標の位置で止まれるようにする（最初は停止方法ごとの停止時間の目安から予測する）。
+ */
+class OvershootModel {
+public:
+  static const int SPEED_BIN_COUNT = 8;     // 速度の区間数
+  static const float SPEED_BIN_DPS;         // 速度の区間幅 (deg/s)
+
+  OvershootModel();
+  void reset();                                                 // 学習結果を初期値に戻す
+  float predict(StopMode mode, float speedDps) const;           // 行き過ぎ量の予測 (deg)
+  void learn(StopMode mode, float speedDps, float overshootDeg); // 実績を学習
+  void print() const;                                           // 学習結果を出力
+
+private:
+  static const int MODE_COUNT = 3;          // 停止方法の数（StopModeの数）
+  static const float PRIOR_STOP_SEC[MODE_COUNT]; // 停止方法ごとの停止時間の目安 (s)
+  static const float LEARNING_RATE;         // 指数平滑の係数
+  static const float MAX_OVERSHOOT_DEG;     // 行き過ぎ量の上限 (deg)
+
+  static int speedBin(float speedDps);      // 速度 -> 区間番号
+
+  float mOvershootDeg[MODE_COUNT][SPEED_BIN_COUNT]; // 区間の中央の速度での行き過ぎ量 (deg)
+  uint8_t mSamples[MODE_COUNT][SPEED_BIN_COUNT];    // 学習した回数（表示用、255で止める）
+};
@@ -0,0 +1,44 @@
+#include "RateScheduler.h"
+
+/**
+ * コンストラクタ
+ * @param groups グループ表（添字がグループ番号）
+ * @param count グループ数
+ */
+RateScheduler::RateScheduler(const RateGroup *groups, int count) : mGroups(groups),
+                                                                    mCount(count),
+                                                                    mTick(UINT32_MAX)
+{
+}
+
+/**
+ * 1tick進める（周期起動ごとに最初に呼ぶ）
+ */
+void RateScheduler::advance()
+{
+  mTick++;
+}
+
+/**
+ * 今回のtickで実行するか判定する
+ * @param group グループ番号
+ * @return true=実行する
+ */
+bool RateScheduler::isDue(int group) const
+{
+  if (group < 0 || group >= mCount)
+  {
+    return false;
+  }
+  const RateGroup &rate = mGroups[group];
+  return mTick % rate.periodTicks == rate.phaseTicks;
+}
+
+/**
+ * 現在のtickを取得する
+ * @return tick（advance()の呼び出し回数 - 1）
+ */
+uint32_t RateScheduler::getTick() const
+{
+  return mTick;
+}
@@ -0,0 +1,216 @@
+#include "ReflectionLinearizer.h"
+#include <stdio.h>
+
+const float ReflectionLinearizer::BIN_CM = 0.25f;  // ±6cmの範囲を記録
+
+ReflectionLinearizer::ReflectionLinearizer() : mEdgeSlope(0.0f),
+                                               mCalibrated(false)
+{
+  beginCalibration();
+}
+
+/**
+ * 校正データを消去して収集を始める（作成済みのテーブルは次の作成まで使える）
+ */
+void ReflectionLinearizer::beginCalibration()
+{
+  for (int i = 0; i < BIN_COUNT; i++)
+  {
+    mBinSum[i] = 0;
+    mBinCount[i] = 0;
+  }
+}
+
+/**
+ * 校正データを追加する
+ * @param reflection 反射光
+ * @param offsetCm 掃引開始位置からの横ずれ (cm、白地側が正)
+ */
+void ReflectionLinearizer::addSample(int reflection, float offsetCm)
+{
+  int index = (int)(offsetCm / BIN_CM + BIN_COUNT / 2.0f);
+  if (index < 0 || index >= BIN_COUNT || mBinCount[index] == UINT16_MAX)
+  {
+    return;
+  }
+  mBinSum[index] += reflection;
+  mBinCount[index]++;
+}
+
+/**
+ * 集めたデータから反射光→横ずれのテーブルを作る
+ * 区間ごとの平均反射光を単調増加に補正し（隣接違反の併合）、黒白の中間をエッジ(横ずれ0)とする。
+ * @return true=作成成功, false=コントラスト不足などで失敗（以前のテーブルを使い続ける）
+ */
+bool ReflectionLinearizer::finishCalibration()
+{
+  // データのある区間を取り出す（offset: cm, level: 平均反射光, weight: サンプル数）
+  float *offset = mWork.offset;
+  float *level = mWork.level;
+  float *weight = mWork.weight;
+  int count = 0;
+  for (int i = 0; i < BIN_COUNT; i++)
+  {
+    if (mBinCount[i] == 0)
+    {
+      continue;
+    }
+    offset[count] = (i - BIN_COUNT / 2 + 0.5f) * BIN_CM;
+    level[count] = (float)mBinSum[i] / mBinCount[i];
+    weight[count] = mBinCount[i];
+    count++;
+  }
+  if (count < 2 || level[count - 1] - level[0] < MIN_CONTRAST)
+  {
+    printf("反射光の校正に失敗しました（区間数: %d）\n", count);
+    return false;
+  }
+
+  // 単調増加に補正（隣接違反の併合、ブロックは左端から連続して並ぶ）
+  float *blockLevel = mWork.blockLevel;
+  float *blockWeight = mWork.blockWeight;
+  uint8_t *blockSize = mWork.blockSize;
+  int blocks = 0;
+  for (int i = 0; i < count; i++)
+  {
+    blockLevel[blocks] = level[i];
+    blockWeight[blocks] = weight[i];
+    blockSize[blocks] = 1;
+    blocks++;
+    while (blocks > 1 && blockLevel[blocks - 2] > blockLevel[blocks - 1])
+    {
+      float w = blockWeight[blocks - 2] + blockWeight[blocks - 1];
+      blockLevel[blocks - 2] = (blockLevel[blocks - 2] * blockWeight[blocks - 2] +
+                                blockLevel[blocks - 1] * blockWeight[blocks - 1]) / w;
+      blockWeight[blocks - 2] = w;
+      blockSize[blocks - 2] += blockSize[blocks - 1];
+      blocks--;
+    }
+  }
+  int index = 0;
+  for (int b = 0; b < blocks; b++)
+  {
+    for (int k = 0; k < blockSize[b]; k++)
+    {
+      level[index++] = blockLevel[b];
+    }
+  }
+
+  // 飽和した範囲は「少なくともここまでずれている」内側の端を使う
+  int blackEnd = 0;
+  while (blackEnd < count - 1 && level[blackEnd + 1] == level[0])
+  {
+    blackEnd++;
+  }
+  int whiteStart = count - 1;
+  while (whiteStart > 0 && level[whiteStart - 1] == level[count - 1])
+  {
+    whiteStart--;
+  }
+
+  // 反射光ごとの横ずれ（同じ反射光が続く区間はその中央）
+  float *table = mWork.table;
+  for (int r = 0; r < REFLECTION_LEVELS; r++)
+  {
+    if (r <= level[0])
+    {
+      table[r] = offset[blackEnd];
+      continue;
+    }
+    if (r >= level[count - 1])
+    {
+      table[r] = offset[whiteStart];
+      continue;
+    }
+    int hi = 1;
+    while (level[hi] < r)
+    {
+      hi++;
+    }
+    if (level[hi] == r)
+    {
+      int last = hi;
+      while (last < count - 1 && level[last + 1] == r)
+      {
+        last++;
+      }
+      table[r] = (offset[hi] + offset[last]) / 2.0f;
+    }
+    else
+    {
+      int lo = hi - 1;
+      table[r] = offset[lo] + (offset[hi] - offset[lo]) * (r - level[lo]) / (level[hi] - level[lo]);
+    }
+  }
+
+  // 黒白の中間をエッジとして原点を合わせ、エッジ付近の傾きを求める
+  int mid = (int)((level[0] + level[count - 1]) / 2.0f + 0.5f);
+  float origin = table[mid];
+  int low = (mid - SLOPE_SPAN < 0) ? 0 : mid - SLOPE_SPAN;
+  int high = (mid + SLOPE_SPAN >= REFLECTION_LEVELS) ? REFLECTION_LEVELS - 1 : mid + SLOPE_SPAN;
+  float width = table[high] - table[low];
+  if (width < BIN_CM)
+  {
+    width = BIN_CM; // 段差状の特性でも傾きを発散させない
+  }
+  mEdgeSlope = (high - low) / width;
+
+  for (int r = 0; r < REFLECTION_LEVELS; r++)
+  {
+    mOffsetTable[r] = (int16_t)((table[r] - origin) * 100.0f);
+  }
+  mCalibrated = true;
+
+  printf("反射光の校正完了: 黒%d 白%d エッジ%d 傾き%.1f/cm 範囲%.1f〜%.1fcm\n",
+         (int)level[0], (int)level[count - 1], mid, mEdgeSlope,
+         offset[blackEnd] - origin, offset[whiteStart] - origin);
+  return true;
+}
+
+/**
+ * テーブル作成済みか
+ * @return true=作成済み
+ */
+bool ReflectionLinearizer::isCalibrated() const
+{
+  return mCalibrated;
+}
+
+/**
+ * 反射光から横ずれを求める
+ * @param reflection 反射光 (0〜100)
+ * @return 横ずれ (cm、エッジ=0、白地側が正)
+ */
+float ReflectionLinearizer::toOffsetCm(int reflection) const
+{
+  if (reflection < 0) reflection = 0;
+  if (reflection >= REFLECTION_LEVELS) reflection = REFLECTION_LEVELS - 1;
+  return mOffsetTable[reflection] / 100.0f;
+}
+
+/**
+ * エッジ付近の傾き取得
+ * @return 横ずれ1cmあたりの反射光の変化
+ */
+float ReflectionLinearizer::getEdgeSlope() const
+{
+  return mEdgeSlope;
+}
+
+/**
+ * 線形化した偏差を求める
+ * 校正済みなら横ずれ×エッジ付近の傾き（エッジは校正で求めた黒白の中間）、
+ * 未校正なら従来どおり反射光 - targetを返す。
+ * @param reflection 反射光
+ * @param target 未校正時の目標値
+ * @return 偏差（反射光の単位）
+ */
+int ReflectionLinearizer::linearize(int reflection, int target) const
+{
+  if (!mCalibrated)
+  {
+    return reflection - target;
+  }
+  float diff = toOffsetCm(reflection) * mEdgeSlope;
+  return (int)(diff + ((diff < 0.0f) ? -0.5f : 0.5f));
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * 反射光→横ずれの線形化テーブル
+ * 走行前にセンサをラインの上でゆっくり横切らせ、エンコーダから求めた横ずれと反射光の組を集めて、
+ * 反射光(0〜100)ごとの横ずれを引くテーブルを作る（単調になるよう補正し、間は線形補間）。
+ * 横ずれをエッジ付近の傾きで反射光の単位に戻して返すので、PDゲインはそのまま使え、
+ * 反射光が飽和し始める範囲でも偏差が横ずれに比例する。
+ */
+class ReflectionLinearizer {
+public:
+  ReflectionLinearizer();
+  void beginCalibration();                          // 校正データを消去して収集開始
+  void addSample(int reflection, float offsetCm);   // 校正データ追加（横ずれは白地側が正）
+  bool finishCalibration();                         // テーブル作成（成功したらtrue）
+  bool isCalibrated() const;                        // テーブル作成済みか
+  float toOffsetCm(int reflection) const;           // 反射光 -> 横ずれ (cm、エッジ=0)
+  float getEdgeSlope() const;                       // エッジ付近の反射光の傾き (1/cm)
+  int linearize(int reflection, int target) const;  // 線形化した偏差（未校正なら反射光 - target）
+
+private:
+  static const int BIN_COUNT = 48;          // 横ずれの区間数
+  static const float BIN_CM;                // 1区間の幅 (cm)
+  static const int REFLECTION_LEVELS = 101; // 反射光の段階数 (0〜100)
+  static const int MIN_CONTRAST = 15;       // 校正成功とみなす黒白の反射光差
+  static const int SLOPE_SPAN = 5;          // 傾きを求める反射光の幅（エッジの±）
+
+  int32_t mBinSum[BIN_COUNT];               // 区間ごとの反射光の合計
+  uint16_t mBinCount[BIN_COUNT];            // 区間ごとのサンプル数
+  int16_t mOffsetTable[REFLECTION_LEVELS];  // 反射光ごとの横ずれ (0.01cm単位)
+
+  // テーブル作成の作業領域（約1.5KBあり、呼び出し元のmain_taskのスタックに置かないようメンバーに持つ）
+  struct Work {
+    float offset[BIN_COUNT];                // データのある区間の横ずれ (cm)
+    float level[BIN_COUNT];                 // 区間の平均反射光（単調化後）
+    float weight[BIN_COUNT];                // 区間のサンプル数
+    float blockLevel[BIN_COUNT];            // 併合したブロックの平均反射光
+    float blockWeight[BIN_COUNT];           // 併合したブロックのサンプル数
+    uint8_t blockSize[BIN_COUNT];           // 併合したブロックの区間数
+    float table[REFLECTION_LEVELS];         // 反射光ごとの横ずれ（原点合わせ前, cm）
+  };
+  Work mWork;                               // テーブル作成の作業領域
+  float mEdgeSlope;                         // エッジ付近の傾き (1/cm)
+  bool mCalibrated;                         // テーブル作成済みフラグ
+};
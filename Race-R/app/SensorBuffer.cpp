@@ -0,0 +1,54 @@
+#include "SensorBuffer.h"
+
+SensorBuffer::SensorBuffer() : mSequence(0),
+                               mWriting(0)
+{
+}
+
+/**
+ * 最新値を書き込む
+ * 次の通番の面に書いてから通番を公開するので、読み出し中の面（現在の通番の面）は壊さない。
+ * @param snapshot 書き込む値
+ */
+void SensorBuffer::publish(const SensorSnapshot &snapshot)
+{
+  uint32_t next = mSequence.load(std::memory_order_relaxed) + 1;
+  mWriting.store(next, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  mSlots[next & 1] = snapshot;
+  mSequence.store(next, std::memory_order_release);
+}
+
+/**
+ * 最新値を読む
+ * コピーの後で、同じ面への次の書き込み（通番+2）が始まっていたら読み直す。
+ * @param snapshot [out] 読み出した値
+ * @return true=読めた, false=未書き込み、または再試行しても上書きが続いた
+ */
+bool SensorBuffer::read(SensorSnapshot &snapshot) const
+{
+  for (int retry = 0; retry <= MAX_RETRY; retry++)
+  {
+    uint32_t sequence = mSequence.load(std::memory_order_acquire);
+    if (sequence == 0)
+    {
+      return false;
+    }
+    snapshot = mSlots[sequence & 1];
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (mWriting.load(std::memory_order_relaxed) - sequence < 2)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * 書き込み回数を取得する
+ * @return 通番（0=未書き込み）
+ */
+uint32_t SensorBuffer::getSequence() const
+{
+  return mSequence.load(std::memory_order_acquire);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+
+/**
+ * センサのスナップショット（センシングタスクが1回の周期でまとめて読んだ値）
+ */
+struct SensorSnapshot {
+  uint64_t timeUs;        // 読み出し時刻 (us)
+  int32_t reflection;     // 反射光
+  uint16_t red;           // RGB（青色検知用）
+  uint16_t green;
+  uint16_t blue;
+  int32_t leftCount;      // 左車輪の回転角 (deg)
+  int32_t rightCount;     // 右車輪の回転角 (deg)
+  int32_t leftSpeed;      // 左車輪の速度 (deg/s)
+  int32_t rightSpeed;     // 右車輪の速度 (deg/s)
+  float gyroHeadingDeg;   // ジャイロのヨー角速度を周期ごとに積分した角度 (deg、反時計回り正)
+  bool gyroValid;         // true=gyroHeadingDegを積分中（バイアス推定済み）
+};
+
+/**
+ * センシングタスク→制御タスクの受け渡し（ロックなし、書き込み1・読み出し複数）
+ * 書き込み側は2面のうち読まれていない方に書いてから通番を進め（シーケンスロック＋ダブルバッファ）、
+ * 読み出し側は通番で最新の面を選んでコピーし、コピー中に2回以上書き込まれていないか確認する。
+ * どちらも待たないので、優先度の高いセンシングタスクが制御タスクを止めることはない。
+ */
+class SensorBuffer {
+public:
+  SensorBuffer();
+  void publish(const SensorSnapshot &snapshot);   // 最新値を書き込む（センシングタスクのみ）
+  bool read(SensorSnapshot &snapshot) const;      // 最新値を読む（まだ書き込みがなければfalse）
+  uint32_t getSequence() const;                   // 書き込み回数
+
+private:
+  static const int MAX_RETRY = 3;     // コピー中に上書きされた場合の再試行回数
+
+  SensorSnapshot mSlots[2];           // 書き込み面（通番の偶奇で交互に使う）
+  std::atomic<uint32_t> mSequence;    // 書き込み済みの通番（0=未書き込み）
+  std::atomic<uint32_t> mWriting;     // 書き込みを始めた通番
+};
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <stdint.h>
+
+// speed_profile_gen で生成した速度プロファイル（tools/speed_profile_gen.cpp の出力で置き換える）
+// SPEED_PROFILE_BIN_COUNTが0の間は速度プロファイルを使わない
+static const int SPEED_PROFILE_BIN_COUNT = 0;
+static const float SPEED_PROFILE_BIN_CM = 5.0f;
+static const uint8_t SPEED_PROFILE_TABLE[] = {
+0
+};
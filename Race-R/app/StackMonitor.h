@@ -0,0 +1,21 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <kernel.h>
+
+/**
+ * タスクのスタック使用量の計測（スタックペインティング）
+ * タスクが起動する前（初期化ルーチン）にスタック領域全体を決まった値で埋めておき、
+ * 後から埋めた値が残っていない範囲を数えて、起動してからの最大使用量（ハイウォーターマーク）を求める。
+ * スタックはアドレスの大きい方から使われるので、先頭から埋めた値が続く範囲が未使用の部分になる。
+ */
+class StackMonitor {
+public:
+  static void paint(STK_T *stack, size_t sizeBytes);               // スタック領域を埋める（タスク起動前に呼ぶ）
+  static size_t measureUsed(const STK_T *stack, size_t sizeBytes); // 最大使用量 (byte)
+  static void print(const char *name, const STK_T *stack, size_t sizeBytes); // 使用量を出力
+
+private:
+  static const STK_T PAINT_PATTERN;  // 埋める値
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+
+/**
+ * 走行ログ1件（制御周期ごと）
+ */
+struct TelemetryRecord {
+  uint32_t tick;        // 制御tick
+  int16_t distanceMm;   // 走行距離 (mm、32m超で一周)
+  int16_t diff;         // 反射光の差分
+  int16_t turnX10;      // 旋回量 ×10
+  int16_t speed;        // 基本速度（パワー%換算）
+};
+
+/**
+ * 走行ログのリングバッファ（ロックなし、書き込み1・読み出し1）
+ * 制御タスクはpush()で記録するだけにし（printfしない）、優先度の低いmain_taskが
+ * flush()でまとめて出力する。書き込み・出力の通算件数をそれぞれの側だけが進めるので、
+ * どちらも待たない。満杯なら新しい記録を捨てて件数を数える（古い記録は出力側のものなので触らない）。
+ */
+class TelemetryBuffer {
+public:
+  static const int CAPACITY = 64;   // 保持件数（2のべき乗、通算件数の一周と割り切れる）
+
+  TelemetryBuffer();
+  void push(const TelemetryRecord &record);   // 1件記録（制御タスクのみ）
+  int flush(int maxRecords);                  // 古い順に最大maxRecords件出力（出力件数を返す、main_taskのみ）
+  int getCount() const;                       // 未出力の件数
+  uint32_t getDropped() const;                // 溢れて捨てた件数
+
+private:
+  TelemetryRecord mRecords[CAPACITY];
+  std::atomic<uint32_t> mWritten;   // 書き込んだ通算件数（制御タスクだけが進める）
+  std::atomic<uint32_t> mRead;      // 出力した通算件数（main_taskだけが進める）
+  std::atomic<uint32_t> mDropped;   // 溢れて捨てた件数
+};
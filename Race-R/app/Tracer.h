@@ -1,5 +1,26 @@
 #include "Motor.h"
 #include "ColorSensor.h"
+#include "WheelSpeedController.h"
+#include "MotionProfile.h"
+#include "DiffDrive.h"
+#include "ImuSampler.h"
+#include "Odometry.h"
+#include "CourseMap.h"
+#include "LineStatusEstimator.h"
+#include "LineOffsetEstimator.h"
+#include "ReflectionLinearizer.h"
+#include "MpcSteering.h"
+#include "IterativeLearning.h"
+#include "GainSchedule.h"
+#include "SensorBuffer.h"
+#include "RateScheduler.h"
+#include "TelemetryBuffer.h"
+#include "WaitUntil.h"
+#include "MotionSupervisor.h"
+#include "WheelActuator.h"
+#include "OvershootModel.h"
+#include <kernel.h>
+#include <atomic>
 
 using namespace spikeapi;
 
@@ -8,20 +29,72 @@ public:
   Tracer();
   void run();
   void init();
+  void arm();                                // 走行開始前の準備（押下後すぐに最初の制御を行えるようにする）
   void terminate();
+  void finish();                             // 走行終了の処理（周期ハンドラ停止後に呼ぶ）
+  void flushTelemetry();                     // 走行ログを出力（main_taskの待ちループから周期的に呼ぶ）
   
   // 初期処理状態確認用（public）
   bool isInitialSequenceCompleted() const;   // 初期処理完了状態取得
+  void calibrateImu();                       // 走行開始前（静止中）のジャイロバイアス推定
+  bool calibrateReflection();                // 走行開始前にラインを横切って反射光の線形化テーブルを作る
+  void sampleSensors();                      // センサをまとめて読みスナップショットを更新（センシングタスク）
+  bool isStopped() const;                    // 停止状態取得
+  bool wasBlocking() const;                  // 直前のrun()で待ちを伴う動作をしたか（タスク統計を分けるため）
+  void printActuationStats() const;          // モーターへの書き込み回数を出力
+  void printMemoryUsage() const;             // 部品ごとのRAM使用量を出力
+  
+  // エッジ選択用（進行方向から見て線のどちら側の縁をたどるか）
+  enum class TraceEdge {
+    LEFT,   // 線の左側の縁（線は右手）
+    RIGHT   // 線の右側の縁（線は左手）
+  };
+  void setTraceEdge(TraceEdge edge);         // トレースするエッジ設定（線を横切らずに切り替える）
+  TraceEdge getTraceEdge() const;            // トレース中のエッジ取得
+  bool switchEdge();                         // 線を横切って反対側のエッジへ移る（制御タスクの動作の中で呼ぶ）
+  
+  // 状態変化の通知（制御タスクから呼ばれる、main_taskへのイベントフラグ通知などに使う）
+  enum class Event {
+    INITIAL_SEQUENCE_DONE,  // 初期処理完了
+    PHASE_CHANGED,          // 青色検知による走行区間の切り替え
+    STOPPED,                // 完全停止
+    MOTION_ABORTED          // 走行動作の中断（時間・走行量の超過、ストール）
+  };
+  typedef void (*EventNotifier)(Event event);
+  void setEventNotifier(EventNotifier notifier); // 通知先設定（走行開始前に設定する）
 
 private:
   Motor leftWheel;
   Motor rightWheel;
   ColorSensor colorSensor;
+  WheelActuator mActuator;              // 左右車輪への出力（同じ値の書き込みを省略）
+  WheelSpeedController mLeftSpeedCtl;   // 左車輪速度制御
+  WheelSpeedController mRightSpeedCtl;  // 右車輪速度制御
+  MotionProfile mMoveProfile;           // 走行動作（executeMotion）用速度プロファイル
+  ImuSampler mImu;                      // ジャイロ（ヨー角速度）サンプリング
+  Odometry mOdometry;                   // 自己位置推定（ジャイロ＋エンコーダ）
+  CourseMap mRecordedMap;               // 今回の走行で記録中のコースマップ
+  CourseMap mReplayMap;                 // 速度計画に使う記録済みコースマップ
+  IterativeLearning mLearning;          // 走行を重ねて学習する操舵補正
+  LineStatusEstimator mLineStatus;      // ライン状態推定
+  LineOffsetEstimator mLineOffset;      // 線に対する横ずれ・向きずれ推定
+  ReflectionLinearizer mReflectionLinearizer; // 反射光→横ずれの線形化
+  SensorBuffer mSensorBuffer;           // センシングタスクからの最新値
+  RateScheduler mScheduler;             // 周期起動ごとの処理の振り分け
+  TelemetryBuffer mTelemetry;           // 走行ログ（まとめて出力）
+  int mBatteryMv;                       // 監視周期で更新するバッテリー電圧 (mV)、0=未取得
+  MotionSupervisor mSupervisor;         // 走行動作の監視（時間・走行量・ストール）
+  OvershootModel mOvershoot;            // 停止時の行き過ぎ量の学習（早めの停止指令に使う）
+  
+  // レートグループ（RATE_GROUPSの添字、周期と位相はTracer.cpp）
+  enum RateGroupId {
+    RATE_CONTROL,     // 毎tick：オドメトリ・ライントレース・色の判定（青色検知）
+    RATE_SUPERVISE,   // 監視（バッテリー電圧）
+    RATE_GROUP_COUNT
+  };
+  static const int TELEMETRY_FLUSH_MAX = 24;  // 1回に出力する走行ログの最大件数（LOG_FLUSH_MSの間に記録する20件より多くする）
   
   // 制御定数
-  static const float Kp;        // 比例定数
-  static const float Kd;        // 微分定数
-  static const int bias;        // バイアス
   static const int target;      // 目標値
   
   // 適応的速度制御用定数
@@ -29,49 +102,181 @@ private:
   static const int SLOW_BASE_SPEED = 30;       // 青色検知後の低速
   static const int MIN_SPEED = 25;             // 最低速度
   
+  // コースマップによる速度計画用定数
+  static const int REPLAY_MAX_SPEED = 70;      // 記録済みコースでの直線最高速度
+  static const float REPLAY_LAT_ACCEL_CMS2;    // 許容横加速度 (cm/s^2)
+  static const float REPLAY_DECEL_CMS2;        // カーブ手前の減速度 (cm/s^2)
+  static const float REPLAY_LOOKAHEAD_CM;      // 曲率の先読み距離 (cm)
+  
+  // 状態フィードバック用定数
+  static const float SF_NATURAL_FREQ;          // 横ずれ応答の固有角振動数 (rad/s)
+  static const float SF_DAMPING;               // 横ずれ応答の減衰比
+  static const float SF_MIN_SPEED_CMS;         // ゲイン計算に使う速度の下限 (cm/s)
+  static const float WHEEL_RESPONSE_SEC;       // 車輪速度の応答時定数 (s)
+  static const float MPC_MAX_TURN;             // 予測操舵の旋回量の上限 (%)
+  
+  // 反射光校正（掃引）用定数
+  static const float CAL_SWEEP_DEG;            // 中央から左右へ振る角度 (deg)
+  static const float CAL_SENSOR_DISTANCE_CM;   // 車軸中心からカラーセンサまでの距離 (cm)
+  static const int CAL_SWEEP_SPEED = 8;        // 掃引時の車輪速度（パワー%換算）
+  static const int CAL_SAMPLE_PERIOD_US = 5 * 1000; // 掃引中のサンプリング周期 (us)
+  static const int CAL_TIMEOUT_US = 5 * 1000 * 1000; // 1回の振りの上限時間 (us)
+  
+  // 反復学習制御
+  static const bool LEARNING_ENABLED = true;   // 学習した補正を使い、今回の誤差を記録する
+  
+  // 曲率フィードフォワード用定数
+  static const float FF_GAIN;                  // フィードフォワードの倍率
+  static const float FF_PREVIEW_CM;            // 曲率の先読み距離 (cm)
+  
   // PID制御用
   mutable int mPreviousError;   // 前回のエラー値（D制御用）
+  TraceGains mGains;            // 現在の区間・速度でのゲイン（GainScheduleTable.h）
   bool mIsInitialized;          // 初期化フラグ
   bool mLineTraceEnabled;       // ライントレース有効フラグ
   bool mBlueDetectionEnabled;   // 青色検知有効フラグ
   int mBlueDetectionCount;      // 青色検知回数カウンタ
   int mCurrentBaseSpeed;        // 現在の基本速度
-  bool mIsStopped;              // 完全停止フラグ
+  std::atomic<bool> mIsStopped; // 完全停止フラグ（main_taskからも読む）
+  EventNotifier mEventNotifier; // 状態変化の通知先（NULL=通知しない）
   
   // 初期処理用フラグ
-  bool mInitialSequenceCompleted;       // 初期処理完了フラグ
+  std::atomic<bool> mInitialSequenceCompleted; // 初期処理完了フラグ（main_taskからも読む）
   unsigned long mInitialStartTime;      // 初期処理開始時刻
   
+  // 速度制御用
+  SYSTIM mLastDriveTime;                // 前回速度制御時刻 (us)、0=未制御
+  SYSTIM mLastOdometryTime;             // 前回オドメトリ更新時刻 (us)、0=未更新
+  float mGyroHeadingDeg;                // ジャイロの積分角 (deg、センシングタスクだけが更新)
+  uint64_t mLastGyroTime;               // 前回ジャイロを積分した時刻 (us)、0=未積分
+  
+  // 走行動作の中断用
+  bool mMotionAborted;                  // 一連の動作の途中で中断した（残りの動作を飛ばす）
+  int mMotionAbortCount;                // 走行開始からの中断回数
+  bool mBlockedInRun;                   // 今回のrun()で待ちを伴う動作をした（実行時間の統計から分ける）
+  
+  // ライン復帰用
+  enum class RecoveryPhase {
+    NONE,       // 復帰動作なし
+    TURN_BACK,  // 最後にエッジ上にいた向きへ戻る
+    SWEEP       // 振り幅を広げながら左右に探索
+  };
+  RecoveryPhase mRecoveryPhase;         // 復帰動作の段階
+  float mLastTurn;                      // 直前の旋回量（ライン状態推定用）
+  float mSearchCenterHeading;           // 探索の中心の向き (deg)
+  float mSearchTargetHeading;           // 現在向かっている向き (deg)
+  float mSweepAmplitude;                // 探索の振り幅 (deg)
+  int mSweepSign;                       // 探索の向き (+1=左, -1=右)
+  SYSTIM mRecoveryStartTime;            // 復帰動作開始時刻 (us)
+  
+  static const TraceEdge INITIAL_TRACE_EDGE = TraceEdge::RIGHT; // 走行開始時のエッジ
+  TraceEdge mTraceEdge;                 // 現在トレースしているエッジ
+  
+  // 操舵制御方式の選択
+  enum class SteeringMode {
+    PD,              // 反射光差分のPD制御（従来方式）
+    STATE_FEEDBACK,  // 横ずれ・向きずれ推定値による状態フィードバック
+    MPC              // 推定値とコースマップの曲率の先読みによる予測操舵
+  };
+  static const SteeringMode STEERING_MODE = SteeringMode::PD; // 使用する操舵制御方式
+  SYSTIM mLastEstimateTime;             // 前回横ずれ推定時刻 (us)、0=未推定
+  
   // 青色検知用定数
   static const int BLUE_THRESHOLD;      // 青色判定閾値
   static const int COLOR_DIFF_THRESHOLD; // 他色との差の閾値
   
-  // 前進制御用定数
-  static const float WHEEL_DIAMETER_CM;  // ホイール直径 (cm)
+  // 速度制御用定数
+  static const SYSTIM SPEED_CONTROL_PERIOD_US = 5 * 1000; // 速度ループ最小周期 (us)
+  static const uint32_t MOTION_TIMEOUT_US = 10 * 1000 * 1000; // 距離の決まっていない動作の上限時間 (us)
+  static const float BLACK_SEARCH_MAX_CM;                     // 黒色検知まで直進する距離の上限 (cm)
+  static const int MAX_MOTION_ABORTS = 3;                     // これだけ中断したら安全のため完全停止
+
+  // 停止方法
+  static const StopMode MOTION_STOP_MODE = StopMode::BRAKE;   // 走行動作の既定の停止方法（目標の位置で止める）
+  static const StopMode FINISH_STOP_MODE = StopMode::BRAKE;   // 完全停止時の停止方法
+  static const bool OVERSHOOT_LEARNING_ENABLED = true;        // ブレーキ・保持の走行動作の後に止まりきるまで待ち、行き過ぎ量を学習する
+
+  // 動作安定化待機用定数
+  static const int STABLE_SPEED_DPS = 10;                  // 停止とみなす車輪速度 (deg/s)
+  static const uint32_t STABILIZE_TIMEOUT_US = 200 * 1000; // 待機の上限時間 (us)
+  static const uint32_t STABILIZE_POLL_US = 5 * 1000;      // 速度を確認する周期 (us)
+  
+  // 速度プロファイル用定数（外側車輪の角速度基準）
+  static const float PROFILE_ACCEL_DPS2;     // 加速度 (deg/s^2)
+  static const float PROFILE_DECEL_DPS2;     // 減速度 (deg/s^2)
+  static const float PROFILE_MIN_SPEED_DPS;  // 発進・停止直前の最低速度 (deg/s)
+  static const float PROFILE_LATENCY_SEC;    // 減速指令の応答遅れ (s)
   
-  // 曲がり方向の定義
-  enum class TurnDirection {
-    STRAIGHT,  // 直進
-    LEFT,      // 左曲がり
-    RIGHT      // 右曲がり
-  };
+  // 左右同期制御用定数
+  static const float SYNC_GAIN_PER_SEC;        // 進捗ずれ1degあたりの速度補正 (deg/s)
+  static const float SYNC_MAX_CORRECTION_DPS; // 速度補正の上限 (deg/s)
+  
+  // IMU・オドメトリ用定数
+  static const SYSTIM ODOMETRY_PERIOD_US = 5 * 1000; // オドメトリ更新の最短間隔 (us、センシングタスクの周期)
+  static const int IMU_YAW_AXIS = 2;                 // ヨー軸に対応するIMUの軸番号
+  static const float IMU_YAW_SIGN;                   // ヨー角速度の符号（反時計回りを正にする）
+  
+  // ライン復帰用定数
+  static const int RECOVERY_SPEED = 20;         // 探索時の旋回速度（パワー%換算）
+  static const float RECOVERY_TOLERANCE_DEG;    // 目標の向きに達したとみなす誤差 (deg)
+  static const float SWEEP_START_DEG;           // 探索の初期振り幅 (deg)
+  static const float SWEEP_STEP_DEG;            // 折り返しごとの振り幅の増分 (deg)
+  static const float SWEEP_MAX_DEG;             // 振り幅の上限 (deg)
+  
+  // エッジ切り替え用定数
+  static const int EDGE_SWITCH_SPEED = 30;      // 線を横切る時の外側車輪の速度（パワー%換算）
+  static const int EDGE_SWITCH_INNER_PCT = 70;  // 内側車輪の速度比率 (%)
+  static const float EDGE_SWITCH_MAX_CM;        // 線を横切れなかったと判断する走行距離 (cm)
   
   // メソッド
+  void traceLine();                           // ライントレース1周期分の実行
+  bool updateLineStatus(int diffReflection);  // ライン状態更新（復帰動作中はtrue）
+  void resetLineStatus();                     // ライン状態を現在地点基準で初期化
+  int getLineSideSign() const;                // 線のある側 (+1=左, -1=右)
+  void startRecovery(bool turnBack);          // ライン復帰動作開始
+  void continueRecovery();                    // ライン復帰動作1周期分の実行
   float calcPropValue(int diffReflection);    // PD制御値計算
+  float calcStateFeedback();                  // 状態フィードバック制御値計算
+  float calcMpcSteering();                    // 予測操舵の制御値計算
+  float updateLineOffset(float &yawRate);     // 横ずれ・向きずれ推定更新（車体速度を返す）
+  static float calcYawRatePerTurn();          // 旋回量1%あたりのヨーレート (rad/s)
+  float calcCurvatureFeedForward(int speed) const; // 曲率フィードフォワード計算
   int calcAdaptiveSpeed(float turn);          // 適応的速度計算
+  int calcPlannedBaseSpeed() const;           // コースマップによる基本速度計算
   int calDiffReflection() const;              // 反射光差分計算
+  SensorSnapshot readSensors() const;         // センサの最新値（センシングタスク未起動なら直接読む）
+  void readSensorsDirect(SensorSnapshot &snapshot) const; // センサを直接読む
   bool detectBlue() const;                    // 青色検知メソッド
-  void moveForward(float distanceCm, TurnDirection direction = TurnDirection::STRAIGHT, float turnIntensity = 0.5f);  // 前進＋曲がりメソッド
+  void handleBlueDetection();                 // 青色検知時の処理（検知回数に応じた動作と再開）
+  void updateSupervision();                   // 監視周期の処理
+  void driveWheels(int leftSpeed, int rightSpeed); // 左右車輪の速度指令（閉ループ）
+  void stopWheels(StopMode mode = StopMode::COAST); // 両輪停止＋速度制御リセット
+  void moveStraight(float distanceCm, StopMode stopMode = MOTION_STOP_MODE);          // 直進
+  void moveArc(float radiusCm, float angleDeg, StopMode stopMode = MOTION_STOP_MODE); // 円弧走行（角度: 正=左旋回）
+  void spinTurn(float angleDeg, StopMode stopMode = MOTION_STOP_MODE);                // 超信地旋回（角度: 正=左旋回）
+  void turnToAngle(float angleDeg, StopMode stopMode = MOTION_STOP_MODE);             // IMUの向きで終了する超信地旋回
+  bool executeMotion(float leftDeg, float rightDeg, int cruiseSpeed, StopMode stopMode,
+                     bool headingTermination = false); // 左右回転角指定の走行（中断時はfalse）
+  void beginSupervision(const char *name, uint32_t timeBudgetUs, float distanceBudgetDeg); // 走行動作の監視開始
+  bool superviseMotion();                             // 走行動作の監視（中断したらfalse）
+  void abortMotion();                                 // 走行動作を中断して停止
+  void recoverFromAbort();                            // 中断後の処理（中断が続いたら完全停止）
+  void updateOdometry();                              // オドメトリ更新（周期制限付き）
+  void integrateGyro(SensorSnapshot &snapshot);       // ジャイロの積分（センシングタスク）
+  static float readHubYawRate();                      // ハブIMUのヨー角速度読み出し
+  static float clampCorrection(float correctionDps); // 左右同期補正量の制限
   void setLineTraceEnabled(bool enabled);     // ライントレース有効/無効設定
   bool isLineTraceEnabled() const;            // ライントレース状態取得
   void setBlueDetectionEnabled(bool enabled); // 青色検知有効/無効設定
   bool isBlueDetectionEnabled() const;        // 青色検知状態取得
   void executeBlueAction();                   // 青色検知時の動作実行
-  void waitForStabilization();                // 動作安定化待機
+  bool waitForStabilization();                // 動作安定化待機（止まったらtrue）
+  template <typename Condition>
+  WaitResult waitMotion(const char *name, Condition condition, uint32_t timeoutUs, uint32_t pollUs); // 制御タスクでの待ち（記録してWaitUntilで待つ）
   void setSlowMode(bool enabled);             // 低速モード設定
   int getCurrentBaseSpeed() const;            // 現在の基本速度取得
   void setCompleteStop(bool stopped);         // 完全停止設定
-  bool isStopped() const;                     // 停止状態取得
+  void notify(Event event);                   // 状態変化を通知
   
   // 初期処理関連メソッド
   void performInitialSequence();             // 初期処理実行
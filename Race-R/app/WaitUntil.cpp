@@ -0,0 +1,17 @@
+#include "WaitUntil.h"
+#include <stdio.h>
+
+/**
+ * 待ち合わせの結果を表示する
+ * @param name 表示名（NULL=表示しない）
+ * @param result 結果
+ */
+void WaitUntil::report(const char *name, const WaitResult &result)
+{
+  if (name == NULL)
+  {
+    return;
+  }
+  printf("待機[%s] %s: %lums (評価 %lu回)\n", name, result.satisfied ? "完了" : "タイムアウト",
+         (unsigned long)(result.elapsedUs / 1000), (unsigned long)result.polls);
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <stdint.h>
+#include <kernel.h>
+#include "Motor.h"
+
+using namespace spikeapi;
+
+/**
+ * 停止の仕方
+ */
+enum class StopMode {
+  COAST,  // 出力を切る（惰性で止まる）
+  BRAKE,  // 短絡ブレーキ（速く止まるが、止まった後は保持しない）
+  HOLD    // 止まった位置を保持する（外から押されても戻す）
+};
+
+/**
+ * 左右車輪への出力（アクチュエーション段）
+ * 左右の指令を1組で受け取り、前回と同じ値の書き込みは省略し、変わった車輪だけを
+ * 続けて書き込む（左右の書き込みの間に他の処理を挟まず、左右の出力の時間差を小さくする）。
+ * モーターへの実際の書き込み回数と、左右の書き込みの時間差の最大を記録する。
+ */
+class WheelActuator {
+public:
+  WheelActuator(Motor &left, Motor &right);
+  void setPower(int leftPower, int rightPower); // 左右のパワー指令 (%)
+  void stop(StopMode mode);                     // 両輪を指定の方法で止める
+  void invalidate();                            // 前回値を忘れ、次の指令を必ず書き込む
+  void resetStats();                            // 書き込み回数の集計をやり直す
+  void print() const;                           // 集計結果を出力
+  int getLeftPower() const;                     // 左車輪に出しているパワー (%)
+  int getRightPower() const;                    // 右車輪に出しているパワー (%)
+  static const char *stopModeName(StopMode mode); // 停止方法の表示名
+
+private:
+  // 最後に書き込んだ出力の種類
+  enum class Output {
+    UNKNOWN,  // 未書き込み（次の指令は必ず書き込む）
+    POWER,    // パワー指令
+    COAST,    // 出力なし
+    BRAKE,    // ブレーキ
+    HOLD      // 位置保持
+  };
+  static Output toOutput(StopMode mode);              // 停止方法に対応する出力の種類
+  static void applyStop(Motor &motor, StopMode mode); // 1車輪を止める
+  void recordSkew(HRTCNT leftTime, HRTCNT rightTime); // 左右の書き込みの時間差を記録
+
+  Motor &mLeft;               // 左車輪
+  Motor &mRight;              // 右車輪
+  Output mLeftOutput;         // 左車輪の最後の出力の種類
+  Output mRightOutput;        // 右車輪の最後の出力の種類
+  int mLeftPower;             // 左車輪の最後のパワー (%)
+  int mRightPower;            // 右車輪の最後のパワー (%)
+  uint32_t mCommandCount;     // 受け取った指令の回数
+  uint32_t mLeftWriteCount;   // 左車輪への書き込み回数
+  uint32_t mRightWriteCount;  // 右車輪への書き込み回数
+  uint32_t mMaxSkewUs;        // 左右両方を書き込んだ時の時間差の最大 (us)
+};
@@ -0,0 +1,66 @@
+/**
+ * 予測操舵の1周期あたりの実行時間計測ツール（Linux上で実行）
+ *
+ * MpcSteering::compute()を乱数の入力で繰り返し呼び、1回あたりの最大・99%・平均の実行時間を表示する。
+ * 計算量は入力の値によらず一定（速度の格子探索だけが速度に依存）なので、ホストでの最大値と
+ * 演算回数から実機での最悪実行時間の見積もりに使う。
+ *
+ * ビルド: g++ -O2 -I Race-L/app -o mpc_bench tools/mpc_bench.cpp Race-L/app/MpcSteering.cpp
+ * 使い方: ./mpc_bench [呼び出し回数（既定 1000000）]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include "MpcSteering.h"
+
+static float randomIn(float low, float high)
+{
+  return low + (high - low) * (float)rand() / RAND_MAX;
+}
+
+int main(int argc, char **argv)
+{
+  int calls = (argc > 1) ? atoi(argv[1]) : 1000000;
+  if (calls <= 0)
+  {
+    fprintf(stderr, "usage: %s [calls]\n", argv[0]);
+    return 1;
+  }
+
+  std::vector<double> elapsedNs(calls);
+  float curvature[MpcSteering::MAX_HORIZON];
+  volatile float sink = 0.0f;  // 最適化で呼び出しが消えないように
+
+  for (int i = 0; i < calls; i++)
+  {
+    float offset = randomIn(-3.0f, 3.0f);
+    float heading = randomIn(-0.5f, 0.5f);
+    float yawRate = randomIn(-3.0f, 3.0f);
+    float speed = randomIn(0.0f, 60.0f);
+    for (int k = 0; k < MpcSteering::HORIZON; k++)
+    {
+      curvature[k] = randomIn(-0.05f, 0.05f);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    sink = sink + MpcSteering::compute(offset, heading, yawRate, speed, curvature, 5.0f);
+    auto end = std::chrono::steady_clock::now();
+    elapsedNs[i] = std::chrono::duration<double, std::nano>(end - start).count();
+  }
+
+  double total = 0.0;
+  for (int i = 0; i < calls; i++)
+  {
+    total += elapsedNs[i];
+  }
+  std::sort(elapsedNs.begin(), elapsedNs.end());
+
+  // 1回あたりの積和: 2点 × (状態3 + 予測区間)、ほかに補間と上下限で数回
+  int multiplyAdds = 2 * (3 + MpcSteering::HORIZON);
+  printf("予測区間 %d周期, 1回あたりの積和 %d回\n", MpcSteering::HORIZON, multiplyAdds);
+  printf("呼び出し %d回: 平均 %.1fns, 99%% %.1fns, 最大 %.1fns（計測の揺らぎを含む）\n",
+         calls, total / calls, elapsedNs[(size_t)(calls * 0.99)], elapsedNs[calls - 1]);
+  return 0;
+}
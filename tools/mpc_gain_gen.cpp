@@ -0,0 +1,296 @@
+/**
+ * 予測操舵（陽的MPC）のゲインテーブル生成ツール（Linux上で実行）
+ *
+ * 線に対する横ずれy・向きずれpsi・車体のヨーレートomega（指令に一次遅れで追従）のモデルで、
+ * 予測区間 HORIZON 周期の有限時間LQ問題（制約なし）を車体速度ごとに解き、
+ * 1周期目の最適ヨーレート指令を
+ *   u = -(Ky*y + Kpsi*psi + Komega*omega) - Σ Fk*kappa[k]
+ * の線形則として取り出す（kappa[k]はk周期先の線の曲率）。
+ * 実機では速度で2点間を補間して内積を取るだけなので、1周期の計算量は一定になる。
+ *
+ * ビルド: g++ -O2 -o mpc_gain_gen tools/mpc_gain_gen.cpp
+ * 使い方: ./mpc_gain_gen [オプション] > Race-L/app/MpcGainTable.h
+ *   --horizon <周期>        予測区間（既定 10）
+ *   --dt <s>                制御周期（既定 0.05、TRACER_CYCの周期と合わせる）
+ *   --lag <s>               ヨーレートの応答時定数（既定 0.05、Tracer::WHEEL_RESPONSE_SECと合わせる）
+ *   --q-offset <重み>       横ずれの重み (1/cm^2、既定 1)
+ *   --q-heading <重み>      向きずれの重み (1/rad^2、既定 20)
+ *   --r-yaw <重み>          ヨーレート指令の重み (s^2/rad^2、既定 0.5)
+ * 速度の格子は SPEEDS_CMS で決める（Tracerの速度範囲を覆うこと）。
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+
+static const int STATE_COUNT = 3;  // y, psi, omega
+static const float SPEEDS_CMS[] = {5.0f, 10.0f, 20.0f, 30.0f, 40.0f, 50.0f};
+static const int SPEED_COUNT = sizeof(SPEEDS_CMS) / sizeof(SPEEDS_CMS[0]);
+
+struct Settings {
+  int horizon;      // 予測区間（周期数）
+  double dt;        // 制御周期 (s)
+  double lag;       // ヨーレートの応答時定数 (s)
+  double qOffset;   // 横ずれの重み
+  double qHeading;  // 向きずれの重み
+  double rYaw;      // ヨーレート指令の重み
+};
+
+typedef std::vector<std::vector<double> > Matrix;
+
+static Matrix makeMatrix(int rows, int cols)
+{
+  return Matrix(rows, std::vector<double>(cols, 0.0));
+}
+
+static Matrix multiply(const Matrix &a, const Matrix &b)
+{
+  Matrix c = makeMatrix(a.size(), b[0].size());
+  for (size_t i = 0; i < a.size(); i++)
+    for (size_t k = 0; k < b.size(); k++)
+      for (size_t j = 0; j < b[0].size(); j++)
+        c[i][j] += a[i][k] * b[k][j];
+  return c;
+}
+
+/**
+ * 連続時間モデルを零次ホールドで離散化する
+ * 状態 [y, psi, omega]、入力 [u(ヨーレート指令), kappa(線の曲率)] をまとめた
+ * 拡大行列の指数関数をテイラー展開で求める。
+ */
+static void discretize(double speed, const Settings &s, Matrix &ad, Matrix &bd)
+{
+  const int n = STATE_COUNT + 2;
+  Matrix m = makeMatrix(n, n);
+  m[0][1] = speed;              // y' = v*psi
+  m[1][2] = -1.0;               // psi' = v*kappa - omega
+  m[1][4] = speed;
+  m[2][2] = -1.0 / s.lag;       // omega' = (u - omega)/lag
+  m[2][3] = 1.0 / s.lag;
+  for (int i = 0; i < n; i++)
+    for (int j = 0; j < n; j++)
+      m[i][j] *= s.dt;
+
+  Matrix result = makeMatrix(n, n);
+  Matrix term = makeMatrix(n, n);
+  for (int i = 0; i < n; i++)
+  {
+    result[i][i] = 1.0;
+    term[i][i] = 1.0;
+  }
+  for (int k = 1; k < 30; k++)
+  {
+    term = multiply(term, m);
+    for (int i = 0; i < n; i++)
+      for (int j = 0; j < n; j++)
+        term[i][j] /= k;
+    for (int i = 0; i < n; i++)
+      for (int j = 0; j < n; j++)
+        result[i][j] += term[i][j];
+  }
+
+  ad = makeMatrix(STATE_COUNT, STATE_COUNT);
+  bd = makeMatrix(STATE_COUNT, 2);
+  for (int i = 0; i < STATE_COUNT; i++)
+  {
+    for (int j = 0; j < STATE_COUNT; j++)
+      ad[i][j] = result[i][j];
+    bd[i][0] = result[i][3];
+    bd[i][1] = result[i][4];
+  }
+}
+
+/**
+ * 連立一次方程式 a*x = b を解く（部分ピボット付きガウス消去、bは複数列）
+ */
+static Matrix solve(Matrix a, Matrix b)
+{
+  int n = a.size();
+  int m = b[0].size();
+  for (int col = 0; col < n; col++)
+  {
+    int pivot = col;
+    for (int i = col + 1; i < n; i++)
+      if (fabs(a[i][col]) > fabs(a[pivot][col])) pivot = i;
+    std::swap(a[col], a[pivot]);
+    std::swap(b[col], b[pivot]);
+    for (int i = 0; i < n; i++)
+    {
+      if (i == col) continue;
+      double f = a[i][col] / a[col][col];
+      for (int j = col; j < n; j++) a[i][j] -= f * a[col][j];
+      for (int j = 0; j < m; j++) b[i][j] -= f * b[col][j];
+    }
+  }
+  for (int i = 0; i < n; i++)
+    for (int j = 0; j < m; j++)
+      b[i][j] /= a[i][i];
+  return b;
+}
+
+/**
+ * 1つの速度について1周期目の最適則のゲインを求める
+ * 予測 X = Sx*x0 + Su*U + Sk*K を評価関数 Σ x'Qx + r*u^2 に代入し、
+ * (Su'QSu + R) U = -Su'Q (Sx*x0 + Sk*K) の解の1行目を取り出す。
+ * @param stateGain [out] Ky, Kpsi, Komega
+ * @param previewGain [out] F0..F(N-1)
+ */
+static void computeGains(double speed, const Settings &s, std::vector<double> &stateGain, std::vector<double> &previewGain)
+{
+  Matrix ad, bd;
+  discretize(speed, s, ad, bd);
+
+  const int n = STATE_COUNT;
+  const int horizon = s.horizon;
+  const int rows = n * horizon;
+
+  // 予測行列（k+1周期目の状態 = ad^(k+1) x0 + Σ ad^(k-j) (bu*u_j + bk*kappa_j)）
+  Matrix sx = makeMatrix(rows, n);
+  Matrix su = makeMatrix(rows, horizon);
+  Matrix sk = makeMatrix(rows, horizon);
+  Matrix power = makeMatrix(n, n);
+  for (int i = 0; i < n; i++) power[i][i] = 1.0;
+  std::vector<Matrix> powers;   // powers[k] = ad^k
+  for (int k = 0; k <= horizon; k++)
+  {
+    powers.push_back(power);
+    power = multiply(power, ad);
+  }
+  for (int k = 0; k < horizon; k++)
+  {
+    for (int i = 0; i < n; i++)
+    {
+      for (int j = 0; j < n; j++)
+        sx[k * n + i][j] = powers[k + 1][i][j];
+      for (int j = 0; j <= k; j++)
+      {
+        double bu = 0.0;
+        double bk = 0.0;
+        for (int l = 0; l < n; l++)
+        {
+          bu += powers[k - j][i][l] * bd[l][0];
+          bk += powers[k - j][i][l] * bd[l][1];
+        }
+        su[k * n + i][j] = bu;
+        sk[k * n + i][j] = bk;
+      }
+    }
+  }
+
+  // 重み付き（Qは対角、omegaは重みなし）
+  double q[STATE_COUNT] = {s.qOffset, s.qHeading, 0.0};
+  Matrix h = makeMatrix(horizon, horizon);
+  Matrix g = makeMatrix(horizon, n + horizon);  // [Su'Q Sx | Su'Q Sk]
+  for (int a = 0; a < horizon; a++)
+  {
+    for (int r = 0; r < rows; r++)
+    {
+      double w = q[r % n] * su[r][a];
+      for (int b = 0; b < horizon; b++) h[a][b] += w * su[r][b];
+      for (int j = 0; j < n; j++) g[a][j] += w * sx[r][j];
+      for (int j = 0; j < horizon; j++) g[a][n + j] += w * sk[r][j];
+    }
+    h[a][a] += s.rYaw;
+  }
+
+  Matrix gain = solve(h, g);
+  stateGain.assign(gain[0].begin(), gain[0].begin() + n);
+  previewGain.assign(gain[0].begin() + n, gain[0].end());
+}
+
+/**
+ * 求めたゲインでの閉ループの極の大きさ（最大）を求める（安定性の確認用）
+ * 曲率0で x(k+1) = (ad - bu*K) x(k) の固有値の絶対値をべき乗法で近似する。
+ */
+static double closedLoopRadius(double speed, const Settings &s, const std::vector<double> &stateGain)
+{
+  Matrix ad, bd;
+  discretize(speed, s, ad, bd);
+  for (int i = 0; i < STATE_COUNT; i++)
+    for (int j = 0; j < STATE_COUNT; j++)
+      ad[i][j] -= bd[i][0] * stateGain[j];
+
+  Matrix power = ad;
+  for (int k = 0; k < 6; k++)
+    power = multiply(power, power);   // ad^64
+  double norm = 0.0;
+  for (int i = 0; i < STATE_COUNT; i++)
+    for (int j = 0; j < STATE_COUNT; j++)
+      norm = fmax(norm, fabs(power[i][j]));
+  return pow(norm, 1.0 / 64.0);
+}
+
+int main(int argc, char **argv)
+{
+  Settings settings = {10, 0.05, 0.05, 1.0, 20.0, 0.5};
+
+  for (int i = 1; i < argc; i++)
+  {
+    if (i + 1 >= argc)
+    {
+      fprintf(stderr, "%s の値がありません\n", argv[i]);
+      return 1;
+    }
+    const char *name = argv[i];
+    double value = atof(argv[++i]);
+    if (strcmp(name, "--horizon") == 0) settings.horizon = (int)value;
+    else if (strcmp(name, "--dt") == 0) settings.dt = value;
+    else if (strcmp(name, "--lag") == 0) settings.lag = value;
+    else if (strcmp(name, "--q-offset") == 0) settings.qOffset = value;
+    else if (strcmp(name, "--q-heading") == 0) settings.qHeading = value;
+    else if (strcmp(name, "--r-yaw") == 0) settings.rYaw = value;
+    else
+    {
+      fprintf(stderr, "usage: %s [options] > MpcGainTable.h\n", argv[0]);
+      return 1;
+    }
+  }
+  if (settings.horizon < 1 || settings.dt <= 0.0 || settings.lag <= 0.0)
+  {
+    fprintf(stderr, "設定値が不正です\n");
+    return 1;
+  }
+
+  printf("#pragma once\n\n");
+  printf("// mpc_gain_gen で生成した予測操舵のゲイン（手で編集しない）\n");
+  printf("// 予測区間 %d周期, 周期 %.3fs, 応答時定数 %.3fs, 重み 横ずれ %.2f 向きずれ %.2f 指令 %.2f\n",
+         settings.horizon, settings.dt, settings.lag, settings.qOffset, settings.qHeading, settings.rYaw);
+  printf("static const int MPC_HORIZON = %d;\n", settings.horizon);
+  printf("static const float MPC_DT_SEC = %.3ff;\n", settings.dt);
+  printf("static const int MPC_SPEED_COUNT = %d;\n", SPEED_COUNT);
+  printf("static const float MPC_SPEEDS_CMS[MPC_SPEED_COUNT] = {");
+  for (int i = 0; i < SPEED_COUNT; i++)
+    printf("%s%.1ff", (i == 0) ? "" : ", ", SPEEDS_CMS[i]);
+  printf("};\n");
+
+  std::vector<std::vector<double> > stateGains;
+  std::vector<std::vector<double> > previewGains;
+  for (int i = 0; i < SPEED_COUNT; i++)
+  {
+    std::vector<double> stateGain, previewGain;
+    computeGains(SPEEDS_CMS[i], settings, stateGain, previewGain);
+    stateGains.push_back(stateGain);
+    previewGains.push_back(previewGain);
+    fprintf(stderr, "v=%4.1fcm/s Ky=%7.4f Kpsi=%7.4f Komega=%7.4f 閉ループ極 |z|max=%.3f\n",
+            SPEEDS_CMS[i], stateGain[0], stateGain[1], stateGain[2],
+            closedLoopRadius(SPEEDS_CMS[i], settings, stateGain));
+  }
+
+  printf("// 状態ゲイン {Ky (rad/s/cm), Kpsi (1/s), Komega}\n");
+  printf("static const float MPC_STATE_GAINS[MPC_SPEED_COUNT][3] = {\n");
+  for (int i = 0; i < SPEED_COUNT; i++)
+    printf("  {%.6ff, %.6ff, %.6ff},\n", stateGains[i][0], stateGains[i][1], stateGains[i][2]);
+  printf("};\n");
+  printf("// 曲率の先読みゲイン (rad/s per 1/cm、k周期先)\n");
+  printf("static const float MPC_PREVIEW_GAINS[MPC_SPEED_COUNT][MPC_HORIZON] = {\n");
+  for (int i = 0; i < SPEED_COUNT; i++)
+  {
+    printf("  {");
+    for (int k = 0; k < settings.horizon; k++)
+      printf("%s%.4ff", (k == 0) ? "" : ", ", previewGains[i][k]);
+    printf("},\n");
+  }
+  printf("};\n");
+  return 0;
+}
@@ -0,0 +1,239 @@
+/**
+ * 時間最適速度プロファイル生成ツール（Linux上で実行）
+ *
+ * 走行ログに出力されたコースマップ（CourseMap::dump()の出力、またはそれを貼り付けた
+ * CourseMapData.h）を読み込み、横加速度・車輪速度・加減速度の制限のもとで
+ * 区間ごとの最速速度を前進・後退の2パスで求め、SpeedProfileTable.hとして出力する。
+ * 出力をRace-L/app またはRace-R/app に置いてビルドすると、Tracerは走行距離から
+ * O(1)で目標速度を引く。
+ *
+ * ビルド: g++ -O2 -o speed_profile_gen tools/speed_profile_gen.cpp
+ * 使い方: ./speed_profile_gen [オプション] 入力ファイル > Race-L/app/SpeedProfileTable.h
+ *   --lat-accel <cm/s^2>     許容横加速度（既定 60）
+ *   --accel <cm/s^2>         加速度（既定 60）
+ *   --decel <cm/s^2>         減速度（既定 80）
+ *   --max-speed <%>          直線での最高速度（パワー%換算、既定 70）
+ *   --min-speed <%>          最低速度（パワー%換算、既定 25）
+ *   --wheel-max <%>          外側車輪の速度上限（パワー%換算、既定 100）
+ *   --start-speed <%>        記録開始地点での速度（既定 0）
+ *   --end-speed <%>          記録終了地点での速度（既定 0）
+ * 車体寸法と速度換算はTracer側の定数（DiffDrive, WheelSpeedController）と合わせること。
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+#include <vector>
+
+// Tracer側と合わせる定数
+static const float BIN_CM = 5.0f;              // CourseMap::BIN_CM
+static const float CURVATURE_SCALE = 10000.0f; // CourseMap::CURVATURE_SCALE
+static const float WHEEL_DIAMETER_CM = 5.4f;   // DiffDrive::WHEEL_DIAMETER_CM
+static const float TRACK_WIDTH_CM = 11.2f;     // DiffDrive::TRACK_WIDTH_CM
+static const float DPS_PER_PERCENT = 10.0f;    // WheelSpeedController::DPS_PER_PERCENT
+
+struct Limits {
+  float latAccel;    // 許容横加速度 (cm/s^2)
+  float accel;       // 加速度 (cm/s^2)
+  float decel;       // 減速度 (cm/s^2)
+  float maxSpeed;    // 最高速度 (%)
+  float minSpeed;    // 最低速度 (%)
+  float wheelMax;    // 車輪速度上限 (%)
+  float startSpeed;  // 開始速度 (%)
+  float endSpeed;    // 終了速度 (%)
+};
+
+/**
+ * パワー%換算の速度を車体速度に換算する
+ */
+static float percentToCms(float percent)
+{
+  return percent * DPS_PER_PERCENT / 360.0f * 3.14159265f * WHEEL_DIAMETER_CM;
+}
+
+/**
+ * 車体速度をパワー%換算の速度に換算する
+ */
+static float cmsToPercent(float cms)
+{
+  return cms / (3.14159265f * WHEEL_DIAMETER_CM) * 360.0f / DPS_PER_PERCENT;
+}
+
+/**
+ * 入力からコースマップの保存値を読み込む
+ * "COURSE_MAP_DATA" の後の '{' から '}' までの整数を区間数分だけ取り出す。
+ */
+static bool loadCourseMap(FILE *fp, std::vector<float> &curvature)
+{
+  std::string text;
+  char buf[4096];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), fp)) > 0)
+  {
+    text.append(buf, n);
+  }
+
+  size_t countPos = text.find("COURSE_MAP_BIN_COUNT");
+  size_t dataPos = text.find("COURSE_MAP_DATA");
+  if (countPos == std::string::npos || dataPos == std::string::npos)
+  {
+    return false;
+  }
+  int count = atoi(text.c_str() + text.find('=', countPos) + 1);
+
+  const char *p = text.c_str() + text.find('{', dataPos) + 1;
+  while ((int)curvature.size() < count && *p != '\0' && *p != '}')
+  {
+    char *end;
+    long value = strtol(p, &end, 10);
+    if (end == p)
+    {
+      p++; // 区切り文字・空白を読み飛ばす
+      continue;
+    }
+    curvature.push_back(value / CURVATURE_SCALE);
+    p = end;
+  }
+  return (int)curvature.size() == count;
+}
+
+/**
+ * 前進・後退の2パスで時間最適な速度列を求める
+ * @param curvature 区間ごとの曲率 (1/cm)
+ * @param limits 制限値
+ * @return 区間ごとの速度 (cm/s)
+ */
+static std::vector<float> planProfile(const std::vector<float> &curvature, const Limits &limits)
+{
+  size_t count = curvature.size();
+  std::vector<float> speed(count);
+
+  // 各区間単独での上限（直線最高速度・横加速度・外側車輪の速度）
+  float maxCms = percentToCms(limits.maxSpeed);
+  float wheelMaxCms = percentToCms(limits.wheelMax);
+  for (size_t i = 0; i < count; i++)
+  {
+    float k = fabsf(curvature[i]);
+    float v = maxCms;
+    if (k > 1.0e-4f)
+    {
+      float lateral = sqrtf(limits.latAccel / k);
+      if (lateral < v) v = lateral;
+    }
+    float wheel = wheelMaxCms / (1.0f + k * TRACK_WIDTH_CM / 2.0f);
+    if (wheel < v) v = wheel;
+    speed[i] = v;
+  }
+
+  // 前進パス：加速度制限
+  float prev = percentToCms(limits.startSpeed);
+  for (size_t i = 0; i < count; i++)
+  {
+    float reachable = sqrtf(prev * prev + 2.0f * limits.accel * BIN_CM);
+    if (reachable < speed[i]) speed[i] = reachable;
+    prev = speed[i];
+  }
+
+  // 後退パス：減速度制限
+  float next = percentToCms(limits.endSpeed);
+  for (size_t i = count; i-- > 0;)
+  {
+    float reachable = sqrtf(next * next + 2.0f * limits.decel * BIN_CM);
+    if (reachable < speed[i]) speed[i] = reachable;
+    next = speed[i];
+  }
+
+  // 最低速度の保証（停止しないように）
+  float minCms = percentToCms(limits.minSpeed);
+  for (size_t i = 0; i < count; i++)
+  {
+    if (speed[i] < minCms) speed[i] = minCms;
+  }
+  return speed;
+}
+
+/**
+ * SpeedProfileTable.hの形式で出力する
+ */
+static void emitTable(const std::vector<float> &speed, const Limits &limits)
+{
+  float lapTime = 0.0f;
+  for (size_t i = 0; i < speed.size(); i++)
+  {
+    lapTime += BIN_CM / speed[i];
+  }
+
+  printf("#pragma once\n\n");
+  printf("#include <stdint.h>\n\n");
+  printf("// speed_profile_gen で生成した速度プロファイル（手で編集しない）\n");
+  printf("// 横加速度 %.0fcm/s^2, 加速度 %.0fcm/s^2, 減速度 %.0fcm/s^2, 最高速度 %.0f%%, 推定走行時間 %.2fs\n",
+         limits.latAccel, limits.accel, limits.decel, limits.maxSpeed, lapTime);
+  printf("// SPEED_PROFILE_BIN_COUNTが0の間は速度プロファイルを使わない\n");
+  printf("static const int SPEED_PROFILE_BIN_COUNT = %d;\n", (int)speed.size());
+  printf("static const float SPEED_PROFILE_BIN_CM = %.1ff;\n", BIN_CM);
+  printf("static const uint8_t SPEED_PROFILE_TABLE[] = {\n");
+  for (size_t i = 0; i < speed.size(); i++)
+  {
+    int percent = (int)(cmsToPercent(speed[i]) + 0.5f);
+    if (percent > 100) percent = 100;
+    printf("%d,%s", percent, (i % 16 == 15) ? "\n" : " ");
+  }
+  printf("0\n};\n");
+
+  fprintf(stderr, "%d区間, 推定走行時間 %.2fs\n", (int)speed.size(), lapTime);
+}
+
+int main(int argc, char **argv)
+{
+  Limits limits = {60.0f, 60.0f, 80.0f, 70.0f, 25.0f, 100.0f, 0.0f, 0.0f};
+  const char *input = NULL;
+
+  for (int i = 1; i < argc; i++)
+  {
+    float *option = NULL;
+    if (strcmp(argv[i], "--lat-accel") == 0) option = &limits.latAccel;
+    else if (strcmp(argv[i], "--accel") == 0) option = &limits.accel;
+    else if (strcmp(argv[i], "--decel") == 0) option = &limits.decel;
+    else if (strcmp(argv[i], "--max-speed") == 0) option = &limits.maxSpeed;
+    else if (strcmp(argv[i], "--min-speed") == 0) option = &limits.minSpeed;
+    else if (strcmp(argv[i], "--wheel-max") == 0) option = &limits.wheelMax;
+    else if (strcmp(argv[i], "--start-speed") == 0) option = &limits.startSpeed;
+    else if (strcmp(argv[i], "--end-speed") == 0) option = &limits.endSpeed;
+    else input = argv[i];
+
+    if (option != NULL)
+    {
+      if (i + 1 >= argc)
+      {
+        fprintf(stderr, "%s の値がありません\n", argv[i]);
+        return 1;
+      }
+      *option = (float)atof(argv[++i]);
+    }
+  }
+
+  if (input == NULL)
+  {
+    fprintf(stderr, "usage: %s [options] course_map.txt > SpeedProfileTable.h\n", argv[0]);
+    return 1;
+  }
+
+  FILE *fp = fopen(input, "r");
+  if (fp == NULL)
+  {
+    fprintf(stderr, "%s を開けません\n", input);
+    return 1;
+  }
+  std::vector<float> curvature;
+  bool loaded = loadCourseMap(fp, curvature);
+  fclose(fp);
+  if (!loaded || curvature.empty())
+  {
+    fprintf(stderr, "%s にコースマップがありません\n", input);
+    return 1;
+  }
+
+  emitTable(planProfile(curvature, limits), limits);
+  return 0;
+}